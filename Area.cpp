@@ -4,21 +4,22 @@
 // This program is released under the BSD license. See the file COPYING for details.
 
 #include <cstdio>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
 #include "Area.h"
 #include "AreaOrderer.h"
+#include "AreaStats.h"
+#include "AreaTrace.h"
 
 #include "TestMacros.h"
 
-double CArea::m_accuracy = 0.01;
-double CArea::m_units = 1.0;
-bool CArea::m_fit_arcs = true;
-double CArea::m_single_area_processing_length = 0.0;
-double CArea::m_processing_done = 0.0;
-bool CArea::m_please_abort = false;
-double CArea::m_MakeOffsets_increment = 0.0;
-double CArea::m_split_processing_length = 0.0;
-bool CArea::m_set_processing_length_in_split = false;
-double CArea::m_after_MakeOffsets_length = 0.0;
+thread_local double CArea::m_accuracy = 0.01;
+thread_local double CArea::m_units = 1.0;
+thread_local bool CArea::m_fit_arcs = true;
+static thread_local CAreaProgress default_progress_for_thread;
+thread_local CAreaProgress* CArea::m_progress = &default_progress_for_thread;
 static const double PI = 3.1415926535897932;
 
 void CArea::append(const CCurve& curve)
@@ -26,6 +27,11 @@ void CArea::append(const CCurve& curve)
 	m_curves.push_back(curve);
 }
 
+void CArea::append(CCurve&& curve)
+{
+	m_curves.push_back(std::move(curve));
+}
+
 void CArea::FitArcs(){
 	for(std::list<CCurve>::iterator It = m_curves.begin(); It != m_curves.end(); It++)
 	{
@@ -52,17 +58,19 @@ Point CArea::NearestPoint(const Point& p)const
 	return best_point;
 }
 
-void CArea::GetBox(CAreaBox &box)
+void CArea::GetBox(CAreaBox &box)const
 {
-	for(std::list<CCurve>::iterator It = m_curves.begin(); It != m_curves.end(); It++)
+	for(std::list<CCurve>::const_iterator It = m_curves.begin(); It != m_curves.end(); It++)
 	{
-		CCurve& curve = *It;
+		const CCurve& curve = *It;
 		curve.GetBox(box);
 	}
 }
 
 void CArea::Reorder()
 {
+	CAreaStatsScope stats(CAreaStats::ReorderOperation, *this);
+	CAreaTraceScope trace("Reorder");
 	// curves may have been added with wrong directions
 	// test all kurves to see which one are outsides and which are insides and 
 	// make sure outsides are anti-clockwise and insides are clockwise
@@ -75,12 +83,15 @@ void CArea::Reorder()
 	{
 		CCurve& curve = *It;
 		ao.Insert(&curve);
-		if(m_set_processing_length_in_split)
+		if(m_progress->m_set_processing_length_in_split)
 		{
-			CArea::m_processing_done += (m_split_processing_length / m_curves.size());
+			CArea::m_progress->AddProcessingDone(m_progress->m_split_processing_length / m_curves.size());
+			CArea::m_progress->Update();
 		}
 	}
-	*this = ao.ResultArea();
+	CArea result;
+	ao.ResultArea(result);
+	m_curves.swap(result.m_curves); // the orderer has moved the curves out of m_curves
 }
 
 class ZigZag
@@ -91,15 +102,15 @@ public:
 	ZigZag(const CCurve& Zig, const CCurve& Zag):zig(Zig), zag(Zag){}
 };
 
-static double stepover_for_pocket = 0.0;
-static std::list<ZigZag> zigzag_list_for_zigs;
-static std::list<CCurve> *curve_list_for_zigs = NULL;
-static bool rightward_for_zigs = true;
-static double sin_angle_for_zigs = 0.0;
-static double cos_angle_for_zigs = 0.0;
-static double sin_minus_angle_for_zigs = 0.0;
-static double cos_minus_angle_for_zigs = 0.0;
-static double one_over_units = 0.0;
+static thread_local double stepover_for_pocket = 0.0;
+static thread_local std::list<ZigZag> zigzag_list_for_zigs;
+static thread_local std::list<CCurve> *curve_list_for_zigs = NULL;
+static thread_local bool rightward_for_zigs = true;
+static thread_local double sin_angle_for_zigs = 0.0;
+static thread_local double cos_angle_for_zigs = 0.0;
+static thread_local double sin_minus_angle_for_zigs = 0.0;
+static thread_local double cos_minus_angle_for_zigs = 0.0;
+static thread_local double one_over_units = 0.0;
 
 static Point rotated_point(const Point &p)
 {
@@ -303,8 +314,75 @@ void make_zig(const CArea &a, double y0, double y)
 	}
 }
         
-std::list< std::list<ZigZag> > reorder_zig_list_list;
-        
+static thread_local std::list< std::list<ZigZag> > reorder_zig_list_list;
+
+// the zig vertices and the list ends are kept in cells as big as the tolerance used to match them,
+// so a match can only be in the cell of the point being matched, or in a cell next to it
+typedef std::pair<long long, long long> ZigCell;
+static thread_local std::map< ZigCell, std::list<Point> > zig_vertex_cells;
+static thread_local std::map< ZigCell, std::set<unsigned int> > zig_list_end_cells; // index in reorder_zig_lists
+static thread_local std::vector< std::list<ZigZag>* > reorder_zig_lists; // in the order they were added to reorder_zig_list_list
+
+static ZigCell zig_cell(const Point &p)
+{
+	double cell_size = 0.002 * one_over_units;
+	return ZigCell((long long)floor(p.x / cell_size), (long long)floor(p.y / cell_size));
+}
+
+static bool zig_points_match(const Point &p0, const Point &p1)
+{
+	return (fabs(p0.x - p1.x) < (0.002 * one_over_units)) && (fabs(p0.y - p1.y) < (0.002 * one_over_units));
+}
+
+static bool near_zig_vertex(const Point &p)
+{
+	ZigCell c = zig_cell(p);
+	for(long long i = c.first - 1; i <= c.first + 1; i++)
+	{
+		for(long long j = c.second - 1; j <= c.second + 1; j++)
+		{
+			std::map< ZigCell, std::list<Point> >::const_iterator FindIt = zig_vertex_cells.find(ZigCell(i, j));
+			if(FindIt == zig_vertex_cells.end())continue;
+			for(std::list<Point>::const_iterator It = FindIt->second.begin(); It != FindIt->second.end(); It++)
+			{
+				if(zig_points_match(p, *It))return true;
+			}
+		}
+	}
+	return false;
+}
+
+static int first_zig_list_ending_at(const Point &p)
+{
+	// returns the index of the earliest list ending at p, or -1
+	int result = -1;
+	ZigCell c = zig_cell(p);
+	for(long long i = c.first - 1; i <= c.first + 1; i++)
+	{
+		for(long long j = c.second - 1; j <= c.second + 1; j++)
+		{
+			std::map< ZigCell, std::set<unsigned int> >::const_iterator FindIt = zig_list_end_cells.find(ZigCell(i, j));
+			if(FindIt == zig_list_end_cells.end())continue;
+			for(std::set<unsigned int>::const_iterator It = FindIt->second.begin(); It != FindIt->second.end(); It++)
+			{
+				unsigned int index = *It;
+				if(result != -1 && (int)index > result)break;
+				if(zig_points_match(p, reorder_zig_lists[index]->back().zig.m_vertices.back().m_p))result = index;
+			}
+		}
+	}
+	return result;
+}
+
+static void add_zig_vertices(const ZigZag &zigzag)
+{
+	for(std::list<CVertex>::const_iterator It = zigzag.zig.m_vertices.begin(); It != zigzag.zig.m_vertices.end(); It++)
+	{
+		const Point &p = It->m_p;
+		zig_vertex_cells[zig_cell(p)].push_back(p);
+	}
+}
+
 void add_reorder_zig(ZigZag &zigzag)
 {
     // look in existing lists
@@ -313,45 +391,34 @@ void add_reorder_zig(ZigZag &zigzag)
 	if(zigzag.zag.m_vertices.size() > 1)
 	{
 		const Point& zag_e = zigzag.zag.m_vertices.front().m_p;
-		bool zag_removed = false;
-		for(std::list< std::list<ZigZag> >::iterator It = reorder_zig_list_list.begin(); It != reorder_zig_list_list.end() && !zag_removed; It++)
+		if(near_zig_vertex(zag_e))
 		{
-			std::list<ZigZag> &zigzag_list = *It;
-			for(std::list<ZigZag>::iterator It2 = zigzag_list.begin(); It2 != zigzag_list.end() && !zag_removed; It2++)
-			{
-				const ZigZag& z = *It2;
-				for(std::list<CVertex>::const_iterator It3 = z.zig.m_vertices.begin(); It3 != z.zig.m_vertices.end() && !zag_removed; It3++)
-				{
-					const CVertex &v = *It3;
-					if((fabs(zag_e.x - v.m_p.x) < (0.002 * one_over_units)) && (fabs(zag_e.y - v.m_p.y) < (0.002 * one_over_units)))
-					{
-						// remove zag from zigzag
-						zigzag.zag.m_vertices.clear();
-						zag_removed = true;
-					}
-				}
-			}
+			// remove zag from zigzag
+			zigzag.zag.m_vertices.clear();
+			zigzag.zag.VerticesChanged();
 		}
 	}
 
+	add_zig_vertices(zigzag);
+
 	// see if the zigzag can join the end of an existing list
 	const Point& zig_s = zigzag.zig.m_vertices.front().m_p;
-	for(std::list< std::list<ZigZag> >::iterator It = reorder_zig_list_list.begin(); It != reorder_zig_list_list.end(); It++)
+	int index = first_zig_list_ending_at(zig_s);
+	if(index != -1)
 	{
-		std::list<ZigZag> &zigzag_list = *It;
-		const ZigZag& last_zigzag = zigzag_list.back();
-        const Point& e = last_zigzag.zig.m_vertices.back().m_p;
-        if((fabs(zig_s.x - e.x) < (0.002 * one_over_units)) && (fabs(zig_s.y - e.y) < (0.002 * one_over_units)))
-		{
-            zigzag_list.push_back(zigzag);
-			return;
-		}
+		std::list<ZigZag> &zigzag_list = *reorder_zig_lists[index];
+		zig_list_end_cells[zig_cell(zigzag_list.back().zig.m_vertices.back().m_p)].erase(index);
+		zigzag_list.push_back(zigzag);
+		zig_list_end_cells[zig_cell(zigzag.zig.m_vertices.back().m_p)].insert(index);
+		return;
 	}
         
     // else add a new list
     std::list<ZigZag> zigzag_list;
     zigzag_list.push_back(zigzag);
     reorder_zig_list_list.push_back(zigzag_list);
+	zig_list_end_cells[zig_cell(zigzag.zig.m_vertices.back().m_p)].insert(reorder_zig_lists.size());
+	reorder_zig_lists.push_back(&reorder_zig_list_list.back());
 }
 
 void reorder_zigs()
@@ -393,13 +460,17 @@ void reorder_zigs()
 		}
 	}
 	reorder_zig_list_list.clear();
+	reorder_zig_lists.clear();
+	zig_vertex_cells.clear();
+	zig_list_end_cells.clear();
 }
 
 static void zigzag(const CArea &input_a)
 {
+	CAreaTraceScope trace("zigzag");
 	if(input_a.m_curves.size() == 0)
 	{
-		CArea::m_processing_done += CArea::m_single_area_processing_length;
+		CArea::m_progress->AddProcessingDone(CArea::m_progress->m_single_area_processing_length);
 		return;
 	}
     
@@ -420,9 +491,9 @@ static void zigzag(const CArea &input_a)
     Point null_point(0, 0);
 	rightward_for_zigs = true;
 
-	if(CArea::m_please_abort)return;
+	if(CArea::m_progress->m_please_abort)return;
 
-	double step_percent_increment = 0.8 * CArea::m_single_area_processing_length / num_steps;
+	double step_percent_increment = 0.8 * CArea::m_progress->m_single_area_processing_length / num_steps;
 
 	for(int i = 0; i<num_steps; i++)
 	{
@@ -443,29 +514,32 @@ static void zigzag(const CArea &input_a)
 		a2.Intersect(a);
 		make_zig(a2, y0, y);
 		rightward_for_zigs = !rightward_for_zigs;
-		if(CArea::m_please_abort)return;
-		CArea::m_processing_done += step_percent_increment;
+		if(CArea::m_progress->m_please_abort)return;
+		CArea::m_progress->AddProcessingDone(step_percent_increment);
+		CArea::m_progress->Update();
 	}
 
 	reorder_zigs();
-	CArea::m_processing_done += 0.2 * CArea::m_single_area_processing_length;
+	CArea::m_progress->AddProcessingDone(0.2 * CArea::m_progress->m_single_area_processing_length);
 }
 
 void CArea::SplitAndMakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketParams &params)const
 {
+	CAreaTraceScope trace("SplitAndMakePocketToolpath");
   dprintf("entered ...\n");
-	CArea::m_processing_done = 0.0;
+	CArea::m_progress->m_processing_done = 0.0;
 
 	double save_units = CArea::m_units;
 	CArea::m_units = 1.0;
 	std::list<CArea> areas;
-	m_split_processing_length = 50.0; // jump to 50 percent after split
-	m_set_processing_length_in_split = true;
+	m_progress->m_split_processing_length = 50.0; // jump to 50 percent after split
+	m_progress->m_set_processing_length_in_split = true;
   dprintf("Split() ...\n");
 	Split(areas);
   dprintf(".. Split() done.\n");
-	m_set_processing_length_in_split = false;
-	CArea::m_processing_done = m_split_processing_length;
+	m_progress->m_set_processing_length_in_split = false;
+	CArea::m_progress->m_processing_done = m_progress->m_split_processing_length;
+	CArea::m_progress->Update();
 	CArea::m_units = save_units;
 
 	if(areas.size() == 0)return;
@@ -477,18 +551,33 @@ void CArea::SplitAndMakePocketToolpath(std::list<CCurve> &curve_list, const CAre
 	for(std::list<CArea>::iterator It = areas.begin(); It != areas.end(); It++)
 	{
     area_num++;
-		CArea::m_single_area_processing_length = single_area_length;
+		CArea::m_progress->m_single_area_processing_length = single_area_length;
 		CArea &ar = *It;
     dprintf("(area %d/%zd) MakePocketToolpath() ...\n", area_num, areas.size());
-		ar.MakePocketToolpath(curve_list, params);
+		std::list<CCurve> region_toolpath;
+		ar.MakePocketToolpath(region_toolpath, params);
     dprintf("(area %d/%zd) ... MakePocketToolpath() done.\n", area_num, areas.size());
+		if(CArea::m_progress->m_please_abort)return;
+		CArea::m_progress->Update();
+		if(CArea::m_progress->m_listener)CArea::m_progress->m_listener->OnRegionToolpath(region_toolpath);
+		curve_list.splice(curve_list.end(), region_toolpath);
 	}
   dprintf("... done processing %zd areas.\n", areas.size());
   dprintf("... done.\n");
 }
 
+class SimplifyOff
+{
+	// turns m_simplify_tolerance off until the end of the scope
+	double m_save;
+public:
+	SimplifyOff():m_save(CArea::m_simplify_tolerance){CArea::m_simplify_tolerance = 0.0;}
+	~SimplifyOff(){CArea::m_simplify_tolerance = m_save;}
+};
+
 void CArea::MakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketParams &params)const
 {
+	CAreaTraceScope trace("MakePocketToolpath");
   dprintf("entered ...\n");
 	double radians_angle = params.zig_angle * PI / 180;
 	sin_angle_for_zigs = sin(-radians_angle);
@@ -500,7 +589,8 @@ void CArea::MakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketP
 	CArea a_offset = *this;
 	double current_offset = params.tool_radius + params.extra_offset;
 
-	a_offset.Offset(current_offset);
+	a_offset.Offset(current_offset); // which simplifies it first, if m_simplify_tolerance is set
+	SimplifyOff simplify_off; // the offsets after this are offsets of offsets, simplifying them too would add up the errors
 
 	if(params.mode == ZigZagPocketMode || params.mode == ZigZagThenSingleOffsetPocketMode)
 	{
@@ -510,15 +600,16 @@ void CArea::MakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketP
 	else if(params.mode == SpiralPocketMode)
 	{
 		std::list<CArea> m_areas;
-		a_offset.Split(m_areas);
-		if(CArea::m_please_abort)return;
+		if(HolesLinked())a_offset.Split(m_areas);
+		else a_offset.SplitOrdered(m_areas); // Offset has already put each outer before its holes
+		if(CArea::m_progress->m_please_abort)return;
 		if(m_areas.size() == 0)
 		{
-			CArea::m_processing_done += CArea::m_single_area_processing_length;
+			CArea::m_progress->AddProcessingDone(CArea::m_progress->m_single_area_processing_length);
 			return;
 		}
 
-		CArea::m_single_area_processing_length /= m_areas.size();
+		CArea::m_progress->m_single_area_processing_length /= m_areas.size();
 
     int area_num = 0;
     dprintf("spiral-pocketing %zd areas ...\n", m_areas.size());
@@ -536,12 +627,8 @@ void CArea::MakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketP
 	if(params.mode == SingleOffsetPocketMode || params.mode == ZigZagThenSingleOffsetPocketMode)
 	{
     dprintf("processing single offset ...\n");
-		// add the single offset too
-		for(std::list<CCurve>::iterator It = a_offset.m_curves.begin(); It != a_offset.m_curves.end(); It++)
-		{
-			CCurve& curve = *It;
-			curve_list.push_back(curve);
-		}
+		// add the single offset too, a_offset isn't needed after this
+		curve_list.splice(curve_list.end(), a_offset.m_curves);
     dprintf("... processing single offset done.\n");
 	}
   dprintf("... done.\n");
@@ -549,6 +636,7 @@ void CArea::MakePocketToolpath(std::list<CCurve> &curve_list, const CAreaPocketP
 
 void CArea::Split(std::list<CArea> &m_areas)const
 {
+	CAreaTraceScope trace("Split");
   dprintf("entered ...\n");
 	if(HolesLinked())
 	{
@@ -571,37 +659,45 @@ void CArea::Split(std::list<CArea> &m_areas)const
 		a.Reorder();
     dprintf("... Reorder() done.\n");
 
-		if(CArea::m_please_abort)return;
+		if(CArea::m_progress->m_please_abort)return;
 
-    int curve_num = 0;
-    dprintf("processing %zd curves ...\n", a.m_curves.size());
-		for(std::list<CCurve>::const_iterator It = a.m_curves.begin(); It != a.m_curves.end(); It++)
+		a.SplitOrdered(m_areas);
+	}
+  dprintf("... done.\n");
+}
+
+void CArea::SplitOrdered(std::list<CArea> &m_areas)
+{
+	// the curves must be as Reorder leaves them, each outer followed by its holes
+	// they are spliced into the new areas, not copied
+  int curve_num = 0;
+  dprintf("processing %zd curves ...\n", m_curves.size());
+	while(m_curves.size() > 0)
+	{
+    curve_num++;
+    dprintf("(curve %d/%zd) checking IsClockwise() ...\n", curve_num, m_curves.size());
+		const CCurve& curve = m_curves.front();
+		if(curve.IsClockwise())
 		{
-      curve_num++;
-      dprintf("(curve %d/%zd) checking IsClockwise() ...\n", curve_num, a.m_curves.size());
-			const CCurve& curve = *It;
-			if(curve.IsClockwise())
-			{
-        dprintf("(curve %d/%zd) ... IsClockwise() returns true.\n", curve_num, a.m_curves.size());
-        dprintf("(curve %d/%zd) checking whether to push curve to area's curve array ...\n", curve_num, a.m_curves.size());
-				if(m_areas.size() > 0){
-          dprintf("(curve %d/%zd) ... yep; pushing curve into last area ...\n", curve_num, a.m_curves.size());
-					m_areas.back().m_curves.push_back(curve);
-        } else {
-          dprintf("(curve %d/%zd) ... nope.\n", curve_num, a.m_curves.size());
-        }
-			}
-			else
-			{
-        dprintf("(curve %d/%zd) ... IsClockwise() returns false; pushing curve into new area ...\n", curve_num, a.m_curves.size());
-				m_areas.push_back(CArea());
-				m_areas.back().m_curves.push_back(curve);
-        dprintf("(curve %d/%zd) ... done pushing curve into new area.\n", curve_num, a.m_curves.size());
-			}
+      dprintf("(curve %d/%zd) ... IsClockwise() returns true.\n", curve_num, m_curves.size());
+      dprintf("(curve %d/%zd) checking whether to push curve to area's curve array ...\n", curve_num, m_curves.size());
+			if(m_areas.size() > 0){
+        dprintf("(curve %d/%zd) ... yep; pushing curve into last area ...\n", curve_num, m_curves.size());
+				m_areas.back().m_curves.splice(m_areas.back().m_curves.end(), m_curves, m_curves.begin());
+      } else {
+        dprintf("(curve %d/%zd) ... nope.\n", curve_num, m_curves.size());
+				m_curves.pop_front();
+      }
+		}
+		else
+		{
+      dprintf("(curve %d/%zd) ... IsClockwise() returns false; pushing curve into new area ...\n", curve_num, m_curves.size());
+			m_areas.push_back(CArea());
+			m_areas.back().m_curves.splice(m_areas.back().m_curves.end(), m_curves, m_curves.begin());
+      dprintf("(curve %d/%zd) ... done pushing curve into new area.\n", curve_num, m_curves.size());
 		}
-    dprintf("... done processing %zd curves.\n", m_curves.size());
 	}
-  dprintf("... done.\n");
+  dprintf("... done processing %zd curves.\n", m_curves.size());
 }
 
 double CArea::GetArea(bool always_add)const
@@ -681,7 +777,7 @@ void CArea::PocketRecursion(std::list<CArea> &areas, const CAreaPocketParams &pa
   for(std::list<CCurve>::iterator c = a_offs.m_curves.begin(); c != a_offs.m_curves.end(); c++){
     c->m_recur_depth = depth;
     CArea a;
-    a.append(*c);
+    a.append(std::move(*c)); // a_offs isn't used again
     a.PocketRecursion(areas, params, depth+1);
   }
 }
@@ -697,15 +793,25 @@ void CArea::RecursivePocket(std::list<CCurve> &curves, const CAreaPocketParams &
   a_offs.PocketRecursion(areas, params, 1);
 
   for(std::list<CArea>::iterator a = areas.begin(); a != areas.end(); a++){
-    for(std::list<CCurve>::iterator c = a->m_curves.begin(); c != a->m_curves.end(); c++){
-      curves.push_back(*c);
-    }
+    curves.splice(curves.end(), a->m_curves);
   }
 }
 
 
+static bool BoxesSeparate(const CAreaBox& b1, const CAreaBox& b2)
+{
+	if(!b1.m_valid || !b2.m_valid)return false;
+	return b1.MaxX() < b2.MinX() || b2.MaxX() < b1.MinX() || b1.MaxY() < b2.MinY() || b2.MaxY() < b1.MinY();
+}
+
 eOverlapType GetOverlapType(const CCurve& c1, const CCurve& c2)
 {
+	// curves whose boxes don't touch are siblings, without copying them into areas to do the booleans
+	CAreaBox b1, b2;
+	c1.GetBox(b1);
+	c2.GetBox(b2);
+	if(BoxesSeparate(b1, b2))return eSiblings;
+
 	CArea a1;
 	a1.m_curves.push_back(c1);
 	CArea a2;
@@ -716,6 +822,11 @@ eOverlapType GetOverlapType(const CCurve& c1, const CCurve& c2)
 
 eOverlapType GetOverlapType(const CArea& a1, const CArea& a2)
 {
+	CAreaBox b1, b2;
+	a1.GetBox(b1);
+	a2.GetBox(b2);
+	if(BoxesSeparate(b1, b2))return eSiblings;
+
 	CArea A1(a1);
 
 	A1.Subtract(a2);
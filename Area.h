@@ -6,6 +6,7 @@
 #define AREA_HEADER
 
 #include "Curve.h"
+#include <atomic>
 
 enum PocketMode
 {
@@ -35,37 +36,76 @@ struct CAreaPocketParams
 	}
 };
 
+class CAreaPocketListener
+{
+	// derive from this to hear about a pocketing job as it goes, rather than after SplitAndMakePocketToolpath returns
+	// these are called on the thread doing the job
+public:
+	virtual ~CAreaPocketListener(){}
+	virtual void OnProgress(double processing_done){}
+	virtual void OnRegionToolpath(const std::list<CCurve> &region_toolpath){} // called as soon as each region's toolpath is finished
+};
+
+class CAreaProgress
+{
+	// progress and cancellation of one processing job
+	// set CArea::m_progress to point at one of these, on the thread doing the job, to watch it or abort it from another thread
+public:
+	std::atomic<double> m_processing_done; // 0.0 to 100.0, set inside MakeOnePocketCurve, can be read from another thread
+	std::atomic<bool> m_please_abort; // the user sets this from another thread, to tell MakeOnePocketCurve to finish with no result.
+	double m_single_area_processing_length;
+	double m_after_MakeOffsets_length;
+	double m_MakeOffsets_increment;
+	double m_split_processing_length;
+	bool m_set_processing_length_in_split;
+	CAreaPocketListener* m_listener; // can be NULL
+
+	CAreaProgress():m_processing_done(0.0), m_please_abort(false), m_single_area_processing_length(0.0), m_after_MakeOffsets_length(0.0), m_MakeOffsets_increment(0.0), m_split_processing_length(0.0), m_set_processing_length_in_split(false), m_listener(NULL){}
+
+	void AddProcessingDone(double d){double done = m_processing_done; while(!m_processing_done.compare_exchange_weak(done, done + d));} // std::atomic<double> has no += before C++20
+	void Update(){if(m_listener)m_listener->OnProgress(m_processing_done);} // call after changing m_processing_done
+};
+
+class CAreaStats;
+
 class CArea
 {
 public:
 	std::list<CCurve> m_curves;
   int m_recur_depth;
-	static double m_accuracy;
-	static double m_units; // 1.0 for mm, 25.4 for inches. All points are multiplied by this before going to the engine
-	static bool m_fit_arcs;
-	static double m_processing_done; // 0.0 to 100.0, set inside MakeOnePocketCurve
-	static double m_single_area_processing_length;
-	static double m_after_MakeOffsets_length;
-	static double m_MakeOffsets_increment;
-	static double m_split_processing_length;
-	static bool m_set_processing_length_in_split;
-	static bool m_please_abort; // the user sets this from another thread, to tell MakeOnePocketCurve to finish with no result.
+	// these settings belong to the calling thread, so different threads can work on different jobs at the same time
+	static thread_local double m_accuracy;
+	static thread_local double m_units; // 1.0 for mm, 25.4 for inches. All points are multiplied by this before going to the engine
+	static thread_local bool m_fit_arcs;
+	static thread_local CAreaProgress* m_progress; // never NULL, each thread starts with its own CAreaProgress
+	static thread_local unsigned int m_strips; // Offset and booleans with at least m_strip_min_vertices vertices are done in this many vertical strips, on separate threads; 0, the default, turns this off
+	static thread_local unsigned int m_strip_min_vertices;
+	static thread_local bool m_arc_booleans; // Offset and booleans are first tried on the arcs themselves, see CAreaArcBoolean; false, the default, turns this off
+	static thread_local double m_simplify_tolerance; // Offset and MakePocketToolpath first Simplify with this, in the same units as m_accuracy; 0, the default, turns this off
+	static thread_local unsigned int m_simplify_vertices_in; // added up by every Simplify, set them to 0 to start counting
+	static thread_local unsigned int m_simplify_vertices_out;
+	static thread_local CAreaStats* m_stats; // can be NULL, each thread starts with its own CAreaStats, see AreaStats.h
 
 	void append(const CCurve& curve);
+	void append(CCurve&& curve);
 	void Subtract(const CArea& a2);
 	void Intersect(const CArea& a2);
 	void Union(const CArea& a2);
 	void Offset(double inwards_value);
 	void FitArcs();
+	unsigned int Simplify(double tolerance); // removes line vertices less than tolerance from the curve without them, arcs are kept and no curves are made to cross; returns the number removed
 	unsigned int num_curves(){return m_curves.size();}
 	Point NearestPoint(const Point& p)const;
-	void GetBox(CAreaBox &box);
+	void GetBox(CAreaBox &box)const;
 	void Reorder();
 	void MakePocketToolpath(std::list<CCurve> &toolpath, const CAreaPocketParams &params)const;
 	void SplitAndMakePocketToolpath(std::list<CCurve> &toolpath, const CAreaPocketParams &params)const;
 	void MakeOnePocketCurve(std::list<CCurve> &curve_list, const CAreaPocketParams &params)const;
 	static bool HolesLinked();
+	static void SetCacheSize(unsigned int max_results); // keep up to this many Offset and boolean results, to reuse for the same inputs; 0, the default, turns the cache off
+	static unsigned int GetCacheSize();
 	void Split(std::list<CArea> &m_areas)const;
+	void SplitOrdered(std::list<CArea> &m_areas); // moves the curves into m_areas, leaving this area empty
 	double GetArea(bool always_add = false)const;
 
   /*
@@ -76,6 +116,36 @@ public:
 	void RecursivePocket(std::list<CCurve> &curves, const CAreaPocketParams &params);
 };
 
+class CAreaSettings
+{
+	// a copy of the calling thread's settings, for handing on to a worker thread
+public:
+	double m_accuracy;
+	double m_units;
+	bool m_fit_arcs;
+	CAreaProgress* m_progress;
+	unsigned int m_strips;
+	unsigned int m_strip_min_vertices;
+	bool m_arc_booleans;
+	double m_simplify_tolerance;
+	CAreaStats* m_stats;
+
+	CAreaSettings():m_accuracy(CArea::m_accuracy), m_units(CArea::m_units), m_fit_arcs(CArea::m_fit_arcs), m_progress(CArea::m_progress), m_strips(CArea::m_strips), m_strip_min_vertices(CArea::m_strip_min_vertices), m_arc_booleans(CArea::m_arc_booleans), m_simplify_tolerance(CArea::m_simplify_tolerance), m_stats(CArea::m_stats){}
+
+	void Apply()const // makes these the settings of the calling thread
+	{
+		CArea::m_accuracy = m_accuracy;
+		CArea::m_units = m_units;
+		CArea::m_fit_arcs = m_fit_arcs;
+		CArea::m_progress = m_progress;
+		CArea::m_strips = m_strips;
+		CArea::m_strip_min_vertices = m_strip_min_vertices;
+		CArea::m_arc_booleans = m_arc_booleans;
+		CArea::m_simplify_tolerance = m_simplify_tolerance;
+		CArea::m_stats = m_stats;
+	}
+};
+
 enum eOverlapType
 {
 	eOutside,
@@ -0,0 +1,661 @@
+// AreaArcBoolean.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CAreaArcBoolean, Offset and booleans done on line and arc spans, without making polygons
+
+#include "AreaArcBoolean.h"
+#include "kurve/geometry.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+thread_local bool CArea::m_arc_booleans = false;
+
+static const double two_pi = 6.283185307179586;
+
+static double Angle(const Point& p, const Point& c)
+{
+	return atan2(p.y - c.y, p.x - c.x);
+}
+
+static double PositiveAngle(double a)
+{
+	// a, made to be from 0 to 2 pi
+	a = fmod(a, two_pi);
+	if(a < 0.0)a += two_pi;
+	return a;
+}
+
+static double Sweep(const Point& p0, const CVertex& v)
+{
+	// how far round an arc goes, more than 0 and up to 2 pi
+	double a = PositiveAngle((Angle(v.m_p, v.m_c) - Angle(p0, v.m_c)) * v.m_type);
+	if(a <= 0.0)a = two_pi;
+	return a;
+}
+
+static Point MidPoint(const Point& p0, const CVertex& v)
+{
+	if(v.m_type == 0)return (p0 + v.m_p) * 0.5;
+	Point r(v.m_c, p0);
+	r.Rotate(Sweep(p0, v) * 0.5 * v.m_type);
+	return v.m_c + r;
+}
+
+static bool SamePoint(const Point& p0, const Point& p1)
+{
+	return p0.x == p1.x && p0.y == p1.y;
+}
+
+class ArcSpan
+{
+	// a span of one of the curves, or a piece of one
+public:
+	Point m_p0;
+	CVertex m_v; // the end of the span
+	int m_operand; // 0 for the area, 1 for a2
+	int m_curve;
+	int m_span; // which input span it is, or was cut from
+	CAreaBox m_box;
+
+	ArcSpan(const Point& p0, const CVertex& v, int operand, int curve, int span):m_p0(p0), m_v(v), m_operand(operand), m_curve(curve), m_span(span){Span(p0, v).GetBox(m_box);}
+
+	double Parameter(const Point& p)const
+	{
+		// 0 at the start, 1 at the end, for a point on the span
+		if(m_v.m_type == 0)
+		{
+			Point v(m_p0, m_v.m_p);
+			return (Point(m_p0, p) * v) / (v * v);
+		}
+		double sweep = Sweep(m_p0, m_v);
+		double a = PositiveAngle((Angle(p, m_v.m_c) - Angle(m_p0, m_v.m_c)) * m_v.m_type);
+		if(a > sweep)return (a - sweep < two_pi - a) ? 1.0 : 0.0;
+		return a / sweep;
+	}
+
+	geoff_geometry::Span GetKurveSpan()const
+	{
+		return geoff_geometry::Span(m_v.m_type, geoff_geometry::Point(m_p0.x, m_p0.y), geoff_geometry::Point(m_v.m_p.x, m_v.m_p.y), geoff_geometry::Point(m_v.m_c.x, m_v.m_c.y));
+	}
+};
+
+class MonotoneSpan
+{
+	// a line, or part of an arc, which only goes one way in y
+public:
+	Point m_p0, m_p1;
+	int m_side; // 0 for a line, -1 for the left half of a circle, 1 for the right half
+	Point m_c;
+	double m_radius;
+	int m_curve;
+
+	MonotoneSpan(const Point& p0, const Point& p1, int side, const Point& c, double radius, int curve):m_p0(p0), m_p1(p1), m_side(side), m_c(c), m_radius(radius), m_curve(curve){}
+
+	double MinY()const{return (m_p0.y < m_p1.y) ? m_p0.y : m_p1.y;}
+	double MaxY()const{return (m_p0.y > m_p1.y) ? m_p0.y : m_p1.y;}
+};
+
+class CArcRayIndex
+{
+	// the spans of some curves, put into bands of y, for telling whether points are inside the curves
+	// by counting the spans crossed going right from the point
+	std::vector<MonotoneSpan> m_spans;
+	std::vector< std::vector<unsigned int> > m_bands;
+	double m_y0, m_y1, m_band_height;
+	double m_tolerance;
+
+	int Crossings(const Point& p, int skip_curve, int only_curve)const;
+
+public:
+	CArcRayIndex():m_y0(0.0), m_y1(0.0), m_band_height(1.0), m_tolerance(0.0){}
+
+	void Add(const Point& p0, const CVertex& v, int curve);
+	void Add(const CCurve& curve, int curve_index);
+	void MakeBands(double tolerance);
+
+	// these return 1 for inside, 0 for outside and -1 for on a span
+	int Inside(const Point& p, int skip_curve = -1)const{return Crossings(p, skip_curve, -1);}
+	int InsideCurve(const Point& p, int curve)const{return Crossings(p, -1, curve);}
+};
+
+void CArcRayIndex::Add(const Point& p0, const CVertex& v, int curve)
+{
+	if(v.m_type == 0)
+	{
+		m_spans.push_back(MonotoneSpan(p0, v.m_p, 0, Point(0, 0), 0.0, curve));
+		return;
+	}
+
+	// cut the arc at the top and bottom of its circle
+	double radius = p0.dist(v.m_c);
+	double sweep = Sweep(p0, v);
+	double a0 = Angle(p0, v.m_c);
+	std::vector< std::pair<double, Point> > cuts;
+	double top = PositiveAngle((two_pi * 0.25 - a0) * v.m_type);
+	double bottom = PositiveAngle((-two_pi * 0.25 - a0) * v.m_type);
+	if(top > 0.0 && top < sweep)cuts.push_back(std::make_pair(top, Point(v.m_c.x, v.m_c.y + radius)));
+	if(bottom > 0.0 && bottom < sweep)cuts.push_back(std::make_pair(bottom, Point(v.m_c.x, v.m_c.y - radius)));
+	std::sort(cuts.begin(), cuts.end(), [](const std::pair<double, Point> &a, const std::pair<double, Point> &b){return a.first < b.first;});
+	cuts.push_back(std::make_pair(sweep, v.m_p));
+
+	Point prev_p = p0;
+	double prev_a = 0.0;
+	for(std::vector< std::pair<double, Point> >::iterator It = cuts.begin(); It != cuts.end(); It++)
+	{
+		double mid_a = a0 + (prev_a + It->first) * 0.5 * v.m_type;
+		m_spans.push_back(MonotoneSpan(prev_p, It->second, (cos(mid_a) < 0.0) ? -1 : 1, v.m_c, radius, curve));
+		prev_p = It->second;
+		prev_a = It->first;
+	}
+}
+
+void CArcRayIndex::Add(const CCurve& curve, int curve_index)
+{
+	const Point* prev_p = NULL;
+	for(std::list<CVertex>::const_iterator It = curve.m_vertices.begin(); It != curve.m_vertices.end(); It++)
+	{
+		if(prev_p)Add(*prev_p, *It, curve_index);
+		prev_p = &(It->m_p);
+	}
+}
+
+void CArcRayIndex::MakeBands(double tolerance)
+{
+	m_tolerance = tolerance;
+	m_bands.clear();
+	if(m_spans.size() == 0)return;
+
+	m_y0 = m_spans[0].MinY();
+	m_y1 = m_spans[0].MaxY();
+	for(std::vector<MonotoneSpan>::iterator It = m_spans.begin(); It != m_spans.end(); It++)
+	{
+		if(It->MinY() < m_y0)m_y0 = It->MinY();
+		if(It->MaxY() > m_y1)m_y1 = It->MaxY();
+	}
+
+	int num_bands = (int)sqrt((double)m_spans.size()) + 1;
+	m_band_height = (m_y1 - m_y0) / num_bands;
+	if(m_band_height <= 0.0){num_bands = 1; m_band_height = 1.0;}
+	m_bands.resize(num_bands);
+	for(unsigned int i = 0; i < m_spans.size(); i++)
+	{
+		int b0 = (int)((m_spans[i].MinY() - m_tolerance - m_y0) / m_band_height);
+		int b1 = (int)((m_spans[i].MaxY() + m_tolerance - m_y0) / m_band_height);
+		if(b0 < 0)b0 = 0;
+		if(b1 >= num_bands)b1 = num_bands - 1;
+		for(int b = b0; b <= b1; b++)m_bands[b].push_back(i);
+	}
+}
+
+int CArcRayIndex::Crossings(const Point& p, int skip_curve, int only_curve)const
+{
+	if(m_bands.size() == 0 || p.y < m_y0 - m_tolerance || p.y > m_y1 + m_tolerance)return 0;
+	int b = (int)((p.y - m_y0) / m_band_height);
+	if(b < 0)b = 0;
+	if(b >= (int)m_bands.size())b = (int)m_bands.size() - 1;
+
+	int inside = 0;
+	const std::vector<unsigned int> &band = m_bands[b];
+	for(std::vector<unsigned int>::const_iterator It = band.begin(); It != band.end(); It++)
+	{
+		const MonotoneSpan &s = m_spans[*It];
+		if(s.m_curve == skip_curve || (only_curve != -1 && s.m_curve != only_curve))continue;
+		if(p.y < s.MinY() - m_tolerance || p.y > s.MaxY() + m_tolerance)continue;
+
+		// on the span?
+		double d;
+		if(s.m_side == 0)
+		{
+			Point v(s.m_p0, s.m_p1);
+			double t = (Point(s.m_p0, p) * v) / (v * v);
+			if(t < 0.0)t = 0.0;
+			if(t > 1.0)t = 1.0;
+			d = p.dist(s.m_p0 + v * t);
+		}
+		else if((p.x - s.m_c.x) * s.m_side >= -m_tolerance)d = fabs(p.dist(s.m_c) - s.m_radius);
+		else d = std::min(p.dist(s.m_p0), p.dist(s.m_p1));
+		if(d <= m_tolerance)return -1;
+
+		if((s.m_p0.y > p.y) == (s.m_p1.y > p.y))continue;
+		double x;
+		if(s.m_side == 0)x = s.m_p0.x + (p.y - s.m_p0.y) * (s.m_p1.x - s.m_p0.x) / (s.m_p1.y - s.m_p0.y);
+		else
+		{
+			double dy = p.y - s.m_c.y;
+			double h = s.m_radius * s.m_radius - dy * dy;
+			x = s.m_c.x + s.m_side * ((h > 0.0) ? sqrt(h) : 0.0);
+		}
+		if(x > p.x)inside = 1 - inside;
+	}
+	return inside;
+}
+
+class CArcBoolean
+{
+	// works out one operation, any failure returns false and the polygon engine is used instead
+	std::vector<CCurve> m_curves[2];
+	CArcRayIndex m_index[2];
+	std::vector<ArcSpan> m_spans;
+	double m_tolerance; // points closer than this are the same point
+	double m_on_tolerance; // pieces closer than this to the other area's spans can't be sorted into inside or outside
+	int m_outers_clockwise; // the way round the outsides went in the first area given, the results go the same way; -1 until known
+
+	static void CopyCurves(const CArea& area, std::vector<CCurve> &curves);
+	void Weld();
+	bool Clean(std::vector<CCurve> &curves)const;
+	bool Orient(int operand);
+	void MakeSpans(int num_operands);
+	bool Intersections(const ArcSpan& a, const ArcSpan& b, std::vector< std::vector<Point> > &cuts)const;
+	bool FindIntersections(std::vector< std::vector<Point> > &cuts)const;
+	bool ChainPieces(const std::vector<ArcSpan> &pieces, const std::vector<bool> &reversed, std::list<CCurve> &curves)const;
+	bool SetResult(CArea &area, std::list<CCurve> &curves)const;
+
+public:
+	CArcBoolean():m_tolerance(Point::tolerance * 0.01), m_on_tolerance(Point::tolerance * 0.1), m_outers_clockwise(-1){}
+
+	bool Boolean(CArea &area, int operation, const CArea& a2);
+	bool Offset(CArea &area, double inwards_value);
+};
+
+void CArcBoolean::CopyCurves(const CArea& area, std::vector<CCurve> &curves)
+{
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)
+	{
+		if(It->m_vertices.size() > 1)curves.push_back(*It);
+	}
+}
+
+void CArcBoolean::Weld()
+{
+	// move the vertices of a2 which are very near to vertices of the area onto them, so they cut each other at exactly those points
+	std::vector<Point> points;
+	for(std::vector<CCurve>::iterator It = m_curves[0].begin(); It != m_curves[0].end(); It++)
+	{
+		for(std::list<CVertex>::iterator VIt = It->m_vertices.begin(); VIt != It->m_vertices.end(); VIt++)points.push_back(VIt->m_p);
+	}
+	std::sort(points.begin(), points.end(), [](const Point &a, const Point &b){return a.x < b.x;});
+
+	for(std::vector<CCurve>::iterator It = m_curves[1].begin(); It != m_curves[1].end(); It++)
+	{
+		for(std::list<CVertex>::iterator VIt = It->m_vertices.begin(); VIt != It->m_vertices.end(); VIt++)
+		{
+			Point &p = VIt->m_p;
+			std::vector<Point>::iterator PIt = std::lower_bound(points.begin(), points.end(), p.x - m_tolerance, [](const Point &a, double x){return a.x < x;});
+			for(; PIt != points.end() && PIt->x <= p.x + m_tolerance; PIt++)
+			{
+				if(p.dist(*PIt) <= m_tolerance){p = *PIt; break;}
+			}
+		}
+		It->VerticesChanged();
+	}
+}
+
+bool CArcBoolean::Clean(std::vector<CCurve> &curves)const
+{
+	// removes zero length spans and curves with no area, returns false for curves which aren't closed
+	std::vector<CCurve> cleaned;
+	for(std::vector<CCurve>::iterator It = curves.begin(); It != curves.end(); It++)
+	{
+		CCurve curve;
+		for(std::list<CVertex>::iterator VIt = It->m_vertices.begin(); VIt != It->m_vertices.end(); VIt++)
+		{
+			if(curve.m_vertices.size() > 0 && curve.m_vertices.back().m_p.dist(VIt->m_p) <= m_tolerance)continue;
+			curve.m_vertices.push_back(*VIt);
+		}
+		if(curve.m_vertices.size() < 2)continue;
+
+		const Point &start = curve.m_vertices.front().m_p;
+		Point &end = curve.m_vertices.back().m_p;
+		if(start.dist(end) > m_tolerance * 10.0)return false;
+		end = start;
+		curve.VerticesChanged();
+		if(curve.m_vertices.size() < 3 && curve.m_vertices.back().m_type == 0)continue;
+		if(fabs(curve.GetArea()) <= m_tolerance * m_tolerance)continue;
+		cleaned.push_back(std::move(curve));
+	}
+	curves.swap(cleaned);
+	return true;
+}
+
+bool CArcBoolean::Orient(int operand)
+{
+	// makes outsides go anti-clockwise and holes clockwise, by how many of the other curves each curve is inside
+	std::vector<CCurve> &curves = m_curves[operand];
+	CArcRayIndex &index = m_index[operand];
+	index = CArcRayIndex();
+	for(unsigned int i = 0; i < curves.size(); i++)index.Add(curves[i], i);
+	index.MakeBands(m_on_tolerance);
+
+	for(unsigned int i = 0; i < curves.size(); i++)
+	{
+		std::list<CVertex>::const_iterator It = curves[i].m_vertices.begin();
+		const Point &p0 = It->m_p;
+		It++;
+		int inside = index.Inside(MidPoint(p0, *It), i);
+		if(inside == -1)return false;
+		if(inside == 0 && m_outers_clockwise == -1)m_outers_clockwise = curves[i].IsClockwise() ? 1 : 0;
+		if(curves[i].IsClockwise() != (inside == 1))curves[i].Reverse();
+	}
+	return true;
+}
+
+void CArcBoolean::MakeSpans(int num_operands)
+{
+	m_spans.clear();
+	for(int operand = 0; operand < num_operands; operand++)
+	{
+		for(unsigned int i = 0; i < m_curves[operand].size(); i++)
+		{
+			const Point* prev_p = NULL;
+			for(std::list<CVertex>::const_iterator It = m_curves[operand][i].m_vertices.begin(); It != m_curves[operand][i].m_vertices.end(); It++)
+			{
+				if(prev_p)m_spans.push_back(ArcSpan(*prev_p, *It, operand, i, (int)m_spans.size()));
+				prev_p = &(It->m_p);
+			}
+		}
+	}
+}
+
+bool CArcBoolean::Intersections(const ArcSpan& a, const ArcSpan& b, std::vector< std::vector<Point> > &cuts)const
+{
+	// adds where a and b cross to both their cuts, returns false if they are from the same operand and cross
+	geoff_geometry::Point gp[2];
+	double t[4];
+	int n = geoff_geometry::Intof(a.GetKurveSpan(), b.GetKurveSpan(), gp[0], gp[1], t);
+	if(n == 2 && Point(gp[0].x, gp[0].y).dist(Point(gp[1].x, gp[1].y)) <= m_tolerance)n = 1;
+
+	for(int i = 0; i < n; i++)
+	{
+		Point p(gp[i].x, gp[i].y);
+
+		if(a.m_operand == b.m_operand)
+		{
+			// only spans of the same curve meeting at their ends are allowed
+			if(a.m_curve != b.m_curve)return false;
+			const Point* ends[2] = {&a.m_p0, &a.m_v.m_p};
+			bool at_shared_end = false;
+			for(int j = 0; j < 2; j++)
+			{
+				if((SamePoint(*ends[j], b.m_p0) || SamePoint(*ends[j], b.m_v.m_p)) && p.dist(*ends[j]) <= m_on_tolerance)at_shared_end = true;
+			}
+			if(!at_shared_end)return false;
+			continue;
+		}
+
+		// use a span end, if the crossing is at one
+		const Point* ends[4] = {&a.m_p0, &a.m_v.m_p, &b.m_p0, &b.m_v.m_p};
+		for(int j = 0; j < 4; j++)
+		{
+			if(p.dist(*ends[j]) <= m_tolerance){p = *ends[j]; break;}
+		}
+		cuts[a.m_span].push_back(p);
+		cuts[b.m_span].push_back(p);
+	}
+	return true;
+}
+
+bool CArcBoolean::FindIntersections(std::vector< std::vector<Point> > &cuts)const
+{
+	// sweep across the spans' boxes, left to right
+	std::vector<unsigned int> order(m_spans.size());
+	for(unsigned int i = 0; i < order.size(); i++)order[i] = i;
+	std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b){return m_spans[a].m_box.MinX() < m_spans[b].m_box.MinX();});
+
+	cuts.resize(m_spans.size());
+	for(unsigned int i = 0; i < order.size(); i++)
+	{
+		const ArcSpan &a = m_spans[order[i]];
+		for(unsigned int j = i + 1; j < order.size(); j++)
+		{
+			const ArcSpan &b = m_spans[order[j]];
+			if(b.m_box.MinX() > a.m_box.MaxX() + m_tolerance)break;
+			if(b.m_box.MinY() > a.m_box.MaxY() + m_tolerance || b.m_box.MaxY() < a.m_box.MinY() - m_tolerance)continue;
+			if(!Intersections(a, b, cuts))return false;
+		}
+	}
+	return true;
+}
+
+bool CArcBoolean::ChainPieces(const std::vector<ArcSpan> &pieces, const std::vector<bool> &reversed, std::list<CCurve> &curves)const
+{
+	// joins the pieces end to start into closed curves, returns false if they don't join up, or more than two meet at a point
+	std::map<std::pair<double, double>, unsigned int> starts;
+	for(unsigned int i = 0; i < pieces.size(); i++)
+	{
+		if(!starts.insert(std::make_pair(std::make_pair(pieces[i].m_p0.x, pieces[i].m_p0.y), i)).second)return false;
+	}
+
+	std::vector<bool> used(pieces.size(), false);
+	for(unsigned int first = 0; first < pieces.size(); first++)
+	{
+		if(used[first])continue;
+		CCurve curve;
+		curve.m_vertices.push_back(CVertex(pieces[first].m_p0));
+		unsigned int i = first;
+		int prev = -1;
+		Point arc_start; // where the last vertex's span starts
+		while(true)
+		{
+			used[i] = true;
+
+			// pieces next to each other, cut from the same span or going round the same circle, go back together
+			bool join = false;
+			if(prev != -1)
+			{
+				const CVertex &v = curve.m_vertices.back();
+				if(pieces[prev].m_span == pieces[i].m_span && reversed[prev] == reversed[i])join = true;
+				else if(v.m_type != 0 && v.m_type == pieces[i].m_v.m_type && SamePoint(v.m_c, pieces[i].m_v.m_c))
+				{
+					join = (Sweep(arc_start, v) + Sweep(pieces[i].m_p0, pieces[i].m_v) < two_pi - 0.001);
+				}
+			}
+			if(join)curve.m_vertices.back().m_p = pieces[i].m_v.m_p;
+			else
+			{
+				arc_start = pieces[i].m_p0;
+				curve.m_vertices.push_back(pieces[i].m_v);
+			}
+
+			const Point &p = pieces[i].m_v.m_p;
+			if(SamePoint(p, pieces[first].m_p0))break;
+			std::map<std::pair<double, double>, unsigned int>::iterator It = starts.find(std::make_pair(p.x, p.y));
+			if(It == starts.end() || used[It->second])return false;
+			prev = i;
+			i = It->second;
+		}
+		curve.VerticesChanged();
+		curves.push_back(std::move(curve));
+	}
+	return true;
+}
+
+bool CArcBoolean::SetResult(CArea &area, std::list<CCurve> &curves)const
+{
+	// puts the outsides, largest first, each followed by its holes, going round the same way as the first area's curves did
+	std::vector<CCurve*> outers;
+	std::vector<CCurve*> holes;
+	for(std::list<CCurve>::iterator It = curves.begin(); It != curves.end(); It++)
+	{
+		if(fabs(It->GetArea()) <= m_tolerance * m_tolerance)continue;
+		if(It->IsClockwise())holes.push_back(&(*It));
+		else outers.push_back(&(*It));
+	}
+	if(holes.size() > 0 && CArea::HolesLinked())return false; // the engine links its holes to their outsides, so leave this to the engine
+	std::stable_sort(outers.begin(), outers.end(), [](const CCurve* a, const CCurve* b){return fabs(a->GetArea()) > fabs(b->GetArea());});
+
+	CArcRayIndex index;
+	std::vector<CAreaBox> boxes(outers.size());
+	for(unsigned int i = 0; i < outers.size(); i++)
+	{
+		index.Add(*outers[i], i);
+		outers[i]->GetBox(boxes[i]);
+	}
+	index.MakeBands(m_on_tolerance);
+
+	// give each hole to the smallest outside around it
+	std::vector< std::vector<CCurve*> > outer_holes(outers.size());
+	for(std::vector<CCurve*>::iterator It = holes.begin(); It != holes.end(); It++)
+	{
+		CAreaBox box;
+		(*It)->GetBox(box);
+		std::list<CVertex>::const_iterator VIt = (*It)->m_vertices.begin();
+		const Point &p0 = VIt->m_p;
+		VIt++;
+		Point p = MidPoint(p0, *VIt);
+		int j = (int)outers.size() - 1;
+		for(; j >= 0; j--)
+		{
+			if(box.MinX() < boxes[j].MinX() || box.MaxX() > boxes[j].MaxX() || box.MinY() < boxes[j].MinY() || box.MaxY() > boxes[j].MaxY())continue;
+			if(index.InsideCurve(p, j) == 1)break;
+		}
+		if(j < 0)return false;
+		outer_holes[j].push_back(*It);
+	}
+
+	area.m_curves.clear();
+	for(unsigned int i = 0; i < outers.size(); i++)
+	{
+		area.m_curves.push_back(std::move(*outers[i]));
+		for(std::vector<CCurve*>::iterator It = outer_holes[i].begin(); It != outer_holes[i].end(); It++)area.m_curves.push_back(std::move(**It));
+	}
+	if(m_outers_clockwise == 1)
+	{
+		for(std::list<CCurve>::iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)It->Reverse();
+	}
+	return true;
+}
+
+bool CArcBoolean::Boolean(CArea &area, int operation, const CArea& a2)
+{
+	CopyCurves(area, m_curves[0]);
+	CopyCurves(a2, m_curves[1]);
+	Weld();
+	for(int operand = 0; operand < 2; operand++)
+	{
+		if(!Clean(m_curves[operand]))return false;
+		if(!Orient(operand))return false;
+	}
+	MakeSpans(2);
+
+	std::vector< std::vector<Point> > cuts;
+	if(!FindIntersections(cuts))return false;
+
+	// cut the spans where they cross, and keep the pieces on the right side of the other area
+	std::vector<ArcSpan> pieces;
+	std::vector<bool> reversed;
+	for(std::vector<ArcSpan>::iterator It = m_spans.begin(); It != m_spans.end(); It++)
+	{
+		const ArcSpan &span = *It;
+		std::vector< std::pair<double, Point> > span_cuts;
+		for(std::vector<Point>::iterator PIt = cuts[span.m_span].begin(); PIt != cuts[span.m_span].end(); PIt++)
+		{
+			if(SamePoint(*PIt, span.m_p0) || SamePoint(*PIt, span.m_v.m_p))continue;
+			double t = span.Parameter(*PIt);
+			if(t > 0.0 && t < 1.0)span_cuts.push_back(std::make_pair(t, *PIt));
+		}
+		std::sort(span_cuts.begin(), span_cuts.end(), [](const std::pair<double, Point> &a, const std::pair<double, Point> &b){return a.first < b.first;});
+		span_cuts.push_back(std::make_pair(1.0, span.m_v.m_p));
+
+		Point p0 = span.m_p0;
+		for(std::vector< std::pair<double, Point> >::iterator CIt = span_cuts.begin(); CIt != span_cuts.end(); CIt++)
+		{
+			if(SamePoint(CIt->second, p0))continue;
+			ArcSpan piece(p0, CVertex(span.m_v.m_type, CIt->second, span.m_v.m_c, span.m_v.m_user_data), span.m_operand, span.m_curve, span.m_span);
+			p0 = CIt->second;
+
+			int inside = m_index[1 - span.m_operand].Inside(MidPoint(piece.m_p0, piece.m_v));
+			if(inside == -1)return false; // along the other area's edge
+			bool keep = false;
+			bool reverse = false;
+			switch(operation)
+			{
+			case CAreaArcBoolean::SubtractOperation:
+				keep = (span.m_operand == 0) ? (inside == 0) : (inside == 1);
+				reverse = (span.m_operand == 1);
+				break;
+			case CAreaArcBoolean::IntersectOperation:
+				keep = (inside == 1);
+				break;
+			case CAreaArcBoolean::UnionOperation:
+				keep = (inside == 0);
+				break;
+			}
+			if(!keep)continue;
+
+			if(reverse)
+			{
+				Point end = piece.m_v.m_p;
+				piece.m_v.m_p = piece.m_p0;
+				piece.m_v.m_type = -piece.m_v.m_type;
+				piece.m_p0 = end;
+			}
+			pieces.push_back(piece);
+			reversed.push_back(reverse);
+		}
+	}
+
+	std::list<CCurve> curves;
+	if(!ChainPieces(pieces, reversed, curves))return false;
+	return SetResult(area, curves);
+}
+
+bool CArcBoolean::Offset(CArea &area, double inwards_value)
+{
+	CopyCurves(area, m_curves[0]);
+	if(!Clean(m_curves[0]))return false;
+	if(!Orient(0))return false;
+
+	// offset each curve with the kurve code, which keeps the arcs, then check the offset curves still make the same shape of area
+	std::vector<bool> clockwise(m_curves[0].size());
+	for(unsigned int i = 0; i < m_curves[0].size(); i++)
+	{
+		CCurve &curve = m_curves[0][i];
+		clockwise[i] = curve.IsClockwise();
+		if(!curve.Offset(inwards_value))return false;
+		if(curve.m_vertices.size() < 2 || curve.m_vertices.front().m_p.dist(curve.m_vertices.back().m_p) > m_tolerance * 10.0)return false;
+	}
+	unsigned int num_curves = (unsigned int)m_curves[0].size();
+	if(!Clean(m_curves[0]) || m_curves[0].size() != num_curves)return false; // one vanished
+	for(unsigned int i = 0; i < num_curves; i++)
+	{
+		if(m_curves[0][i].IsClockwise() != clockwise[i])return false; // turned inside out
+	}
+
+	MakeSpans(1);
+	std::vector< std::vector<Point> > cuts;
+	if(!FindIntersections(cuts))return false;
+	if(!Orient(0))return false;
+	for(unsigned int i = 0; i < num_curves; i++)
+	{
+		if(m_curves[0][i].IsClockwise() != clockwise[i])return false; // a hole went outside its outside
+	}
+
+	std::list<CCurve> curves;
+	for(std::vector<CCurve>::iterator It = m_curves[0].begin(); It != m_curves[0].end(); It++)curves.push_back(std::move(*It));
+	return SetResult(area, curves);
+}
+
+static bool HasArcs(const CArea& area)
+{
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)
+	{
+		for(std::list<CVertex>::const_iterator VIt = It->m_vertices.begin(); VIt != It->m_vertices.end(); VIt++)
+		{
+			if(VIt->m_type != 0)return true;
+		}
+	}
+	return false;
+}
+
+bool CAreaArcBoolean::Do(CArea &area, int operation, const CArea* a2, double value)
+{
+	if(!CArea::m_arc_booleans)return false;
+
+	CArcBoolean job;
+	if(operation == OffsetOperation)return job.Offset(area, value);
+
+	// polygons are left to the polygon engine, they have no arcs to lose
+	if(!HasArcs(area) && !HasArcs(*a2))return false;
+	return job.Boolean(area, operation, *a2);
+}
@@ -0,0 +1,26 @@
+// AreaArcBoolean.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "Area.h"
+
+class CAreaArcBoolean
+{
+	// Offset and booleans worked out on the line and arc spans themselves, instead of on polygons made from them
+	// the spans are cut where they cross, using the kurve code's line and arc intersections, and each piece is kept or thrown away
+	// so the arcs come out as arcs, with no extra vertices and no FitArcs
+	// the caller's m_arc_booleans decides when this is used, see CArea
+public:
+	enum
+	{
+		SubtractOperation,
+		IntersectOperation,
+		UnionOperation,
+		OffsetOperation,
+	};
+
+	// returns false, leaving area as it was, for anything it can't do exactly, then the polygon engine is used instead
+	// that is edges lying along each other, curves crossing themselves or touching at a point, and offsets where curves vanish or meet
+	static bool Do(CArea &area, int operation, const CArea* a2, double value = 0.0);
+};
@@ -4,10 +4,18 @@
 //    Licence: see kboollicense.txt 
 
 #include "Area.h"
+#include "AreaCache.h"
+#include "AreaArcBoolean.h"
+#include "AreaStrips.h"
+#include "AreaStats.h"
+#include "AreaTrace.h"
 #include "kbool/include/_lnk_itr.h"
 #include "kbool/include/booleng.h"
 
 bool CArea::HolesLinked(){ return true; }
+size_t CAreaStats::EngineBytesInUse(){ return KBoolPoolBytesInUse(); }
+size_t CAreaStats::EnginePeakBytes(){ return KBoolPoolPeakBytes(); }
+void CAreaStats::SetEnginePeakBytes(size_t bytes){ KBoolPoolSetPeakBytes(bytes); }
 
 static void ArmBoolEng( Bool_Engine* booleng )
 {
@@ -167,47 +175,80 @@ static void SetFromResult( CArea &area, Bool_Engine* booleng )
         }
 		curve.m_vertices.push_back(curve.m_vertices.front()); // make a copy of the first point at the end
 
-		curve.FitArcs();
+		if(CArea::m_fit_arcs)curve.FitArcs();
         booleng->EndPolygonGet();
     }
 }
 
 void CArea::Subtract(const CArea& a2)
 {
+	CAreaStatsScope stats(CAreaStats::BooleanOperation, *this, &a2);
+	CAreaTraceScope trace("Subtract");
+	CAreaCacheLookup cache(*this, CAreaCacheLookup::SubtractOperation, &a2);
+	if(cache.Found())return;
+	if(CAreaArcBoolean::Do(*this, CAreaArcBoolean::SubtractOperation, &a2)){cache.Store(); return;}
+	if(CAreaStrips::Do(*this, CAreaStrips::SubtractOperation, &a2)){cache.Store(); return;}
+
 	Bool_Engine* booleng = new Bool_Engine();
 	ArmBoolEng( booleng );
 	MakeGroup( *this, booleng, true );
 	MakeGroup( a2, booleng, false );
 	booleng->Do_Operation(BOOL_A_SUB_B);
 	SetFromResult( *this, booleng );
+	cache.Store();
 }
 
 void CArea::Intersect(const CArea& a2)
 {
+	CAreaStatsScope stats(CAreaStats::BooleanOperation, *this, &a2);
+	CAreaTraceScope trace("Intersect");
+	CAreaCacheLookup cache(*this, CAreaCacheLookup::IntersectOperation, &a2);
+	if(cache.Found())return;
+	if(CAreaArcBoolean::Do(*this, CAreaArcBoolean::IntersectOperation, &a2)){cache.Store(); return;}
+	if(CAreaStrips::Do(*this, CAreaStrips::IntersectOperation, &a2)){cache.Store(); return;}
+
 	Bool_Engine* booleng = new Bool_Engine();
 	ArmBoolEng( booleng );
 	MakeGroup( *this, booleng, true );
 	MakeGroup( a2, booleng, false );
 	booleng->Do_Operation(BOOL_AND);
 	SetFromResult( *this, booleng );
+	cache.Store();
 }
 
 void CArea::Union(const CArea& a2)
 {
+	CAreaStatsScope stats(CAreaStats::BooleanOperation, *this, &a2);
+	CAreaTraceScope trace("Union");
+	CAreaCacheLookup cache(*this, CAreaCacheLookup::UnionOperation, &a2);
+	if(cache.Found())return;
+	if(CAreaArcBoolean::Do(*this, CAreaArcBoolean::UnionOperation, &a2)){cache.Store(); return;}
+	if(CAreaStrips::Do(*this, CAreaStrips::UnionOperation, &a2)){cache.Store(); return;}
+
 	Bool_Engine* booleng = new Bool_Engine();
 	ArmBoolEng( booleng );
 	MakeGroup( *this, booleng, true );
 	MakeGroup( a2, booleng, false );
 	booleng->Do_Operation(BOOL_OR);
 	SetFromResult( *this, booleng );
+	cache.Store();
 }
 
 void CArea::Offset(double inwards_value)
 {
+	CAreaStatsScope stats(CAreaStats::OffsetOperation, *this);
+	CAreaTraceScope trace("Offset");
+	if(m_simplify_tolerance > 0.0)Simplify(m_simplify_tolerance / m_units);
+	CAreaCacheLookup cache(*this, CAreaCacheLookup::OffsetOperation, NULL, inwards_value);
+	if(cache.Found())return;
+	if(CAreaArcBoolean::Do(*this, CAreaArcBoolean::OffsetOperation, NULL, inwards_value)){cache.Store(); return;}
+	if(CAreaStrips::Do(*this, CAreaStrips::OffsetOperation, NULL, inwards_value)){cache.Store(); return;}
+
 	Bool_Engine* booleng = new Bool_Engine();
 	ArmBoolEng( booleng );
 	MakeGroup( *this, booleng, true);
 	booleng->SetCorrectionFactor( -inwards_value * m_units );
 	booleng->Do_Operation(BOOL_CORRECTION);
 	SetFromResult( *this, booleng );
+	cache.Store();
 }
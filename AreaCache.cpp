@@ -0,0 +1,225 @@
+// AreaCache.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CAreaCacheLookup and CArea::SetCacheSize, the cache of Offset and boolean results
+
+#include "AreaCache.h"
+#include <map>
+#include <mutex>
+#include <string.h>
+
+class CAreaCacheEntry
+{
+public:
+	unsigned long long m_hash;
+	int m_operation;
+	double m_value;
+	double m_accuracy;
+	double m_units;
+	bool m_fit_arcs;
+	bool m_arc_booleans;
+	unsigned int m_strips;
+	unsigned int m_strip_min_vertices;
+	CArea m_input;
+	CArea m_input2;
+	CArea m_result;
+};
+
+typedef std::list<CAreaCacheEntry> CacheList;
+
+static std::mutex cache_mutex;
+static unsigned int cache_max_results = 0;
+static CacheList cache_entries; // the most recently used first
+static std::multimap<unsigned long long, CacheList::iterator> cache_index; // by hash
+
+static void HashAdd(unsigned long long &hash, unsigned long long value)
+{
+	// FNV-1a, a byte at a time
+	for(int i = 0; i<8; i++)
+	{
+		hash ^= (value >> (i * 8)) & 0xff;
+		hash *= 1099511628211ULL;
+	}
+}
+
+static void HashAdd(unsigned long long &hash, double value)
+{
+	if(value == 0.0)value = 0.0; // so -0.0 hashes the same as 0.0
+	unsigned long long bits;
+	memcpy(&bits, &value, sizeof(bits));
+	HashAdd(hash, bits);
+}
+
+static void HashAdd(unsigned long long &hash, const CCurve& curve)
+{
+	HashAdd(hash, (unsigned long long)curve.m_vertices.size());
+	for(std::list<CVertex>::const_iterator VIt = curve.m_vertices.begin(); VIt != curve.m_vertices.end(); VIt++)
+	{
+		const CVertex& vertex = *VIt;
+		HashAdd(hash, (unsigned long long)(vertex.m_type + 1));
+		HashAdd(hash, vertex.m_p.x);
+		HashAdd(hash, vertex.m_p.y);
+		if(vertex.m_type)
+		{
+			HashAdd(hash, vertex.m_c.x);
+			HashAdd(hash, vertex.m_c.y);
+		}
+		HashAdd(hash, (unsigned long long)vertex.m_user_data);
+	}
+}
+
+static void HashAdd(unsigned long long &hash, const CArea& area)
+{
+	HashAdd(hash, (unsigned long long)area.m_curves.size());
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)
+		HashAdd(hash, *It);
+}
+
+unsigned long long GetGeometryHash(const CCurve& curve)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	HashAdd(hash, curve);
+	return hash;
+}
+
+unsigned long long GetGeometryHash(const CArea& area)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	HashAdd(hash, area);
+	return hash;
+}
+
+bool SameGeometry(const CCurve& c1, const CCurve& c2)
+{
+	if(c1.m_vertices.size() != c2.m_vertices.size())return false;
+	for(std::list<CVertex>::const_iterator VIt1 = c1.m_vertices.begin(), VIt2 = c2.m_vertices.begin(); VIt1 != c1.m_vertices.end(); VIt1++, VIt2++)
+	{
+		const CVertex& v1 = *VIt1;
+		const CVertex& v2 = *VIt2;
+		if(v1.m_type != v2.m_type || v1.m_user_data != v2.m_user_data)return false;
+		if(v1.m_p.x != v2.m_p.x || v1.m_p.y != v2.m_p.y)return false;
+		if(v1.m_type && (v1.m_c.x != v2.m_c.x || v1.m_c.y != v2.m_c.y))return false;
+	}
+	return true;
+}
+
+bool SameGeometry(const CArea& a1, const CArea& a2)
+{
+	if(a1.m_curves.size() != a2.m_curves.size())return false;
+	for(std::list<CCurve>::const_iterator It1 = a1.m_curves.begin(), It2 = a2.m_curves.begin(); It1 != a1.m_curves.end(); It1++, It2++)
+	{
+		if(!SameGeometry(*It1, *It2))return false;
+	}
+	return true;
+}
+
+static CacheList::iterator FindEntry(unsigned long long hash, int operation, double value, const CArea& input, const CArea& input2)
+{
+	// call with cache_mutex locked
+	std::pair<std::multimap<unsigned long long, CacheList::iterator>::iterator, std::multimap<unsigned long long, CacheList::iterator>::iterator> range = cache_index.equal_range(hash);
+	for(std::multimap<unsigned long long, CacheList::iterator>::iterator It = range.first; It != range.second; It++)
+	{
+		CAreaCacheEntry &entry = *(It->second);
+		if(entry.m_operation == operation && entry.m_value == value && entry.m_accuracy == CArea::m_accuracy && entry.m_units == CArea::m_units && entry.m_fit_arcs == CArea::m_fit_arcs
+			&& entry.m_arc_booleans == CArea::m_arc_booleans && entry.m_strips == CArea::m_strips && entry.m_strip_min_vertices == CArea::m_strip_min_vertices
+			&& SameGeometry(entry.m_input, input) && SameGeometry(entry.m_input2, input2))
+			return It->second;
+	}
+	return cache_entries.end();
+}
+
+static void RemoveLeastRecentlyUsed()
+{
+	// call with cache_mutex locked
+	while(cache_entries.size() > cache_max_results)
+	{
+		CacheList::iterator last = cache_entries.end();
+		last--;
+		std::pair<std::multimap<unsigned long long, CacheList::iterator>::iterator, std::multimap<unsigned long long, CacheList::iterator>::iterator> range = cache_index.equal_range(last->m_hash);
+		for(std::multimap<unsigned long long, CacheList::iterator>::iterator It = range.first; It != range.second; It++)
+		{
+			if(It->second == last)
+			{
+				cache_index.erase(It);
+				break;
+			}
+		}
+		cache_entries.erase(last);
+	}
+}
+
+void CArea::SetCacheSize(unsigned int max_results)
+{
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	cache_max_results = max_results;
+	RemoveLeastRecentlyUsed();
+}
+
+unsigned int CArea::GetCacheSize()
+{
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	return cache_max_results;
+}
+
+CAreaCacheLookup::CAreaCacheLookup(CArea &area, int operation, const CArea* a2, double value):m_area(area), m_use_cache(false), m_operation(operation), m_value(value), m_hash(14695981039346656037ULL)
+{
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		m_use_cache = (cache_max_results > 0);
+	}
+	if(!m_use_cache)return;
+
+	m_input.m_curves = area.m_curves;
+	if(a2)m_input2.m_curves = a2->m_curves;
+
+	HashAdd(m_hash, (unsigned long long)operation);
+	HashAdd(m_hash, value);
+	HashAdd(m_hash, CArea::m_accuracy);
+	HashAdd(m_hash, CArea::m_units);
+	HashAdd(m_hash, (unsigned long long)CArea::m_fit_arcs);
+	HashAdd(m_hash, (unsigned long long)CArea::m_arc_booleans);
+	HashAdd(m_hash, (unsigned long long)CArea::m_strips);
+	HashAdd(m_hash, (unsigned long long)CArea::m_strip_min_vertices);
+	HashAdd(m_hash, m_input);
+	HashAdd(m_hash, m_input2);
+}
+
+bool CAreaCacheLookup::Found()
+{
+	if(!m_use_cache)return false;
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	CacheList::iterator It = FindEntry(m_hash, m_operation, m_value, m_input, m_input2);
+	if(It == cache_entries.end())return false;
+
+	cache_entries.splice(cache_entries.begin(), cache_entries, It); // now the most recently used
+	m_area.m_curves = It->m_result.m_curves;
+	return true;
+}
+
+void CAreaCacheLookup::Store()
+{
+	if(!m_use_cache)return;
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	if(cache_max_results == 0)return; // turned off while the operation was running
+	if(FindEntry(m_hash, m_operation, m_value, m_input, m_input2) != cache_entries.end())return; // another thread stored it first
+
+	cache_entries.push_front(CAreaCacheEntry());
+	CAreaCacheEntry &entry = cache_entries.front();
+	entry.m_hash = m_hash;
+	entry.m_operation = m_operation;
+	entry.m_value = m_value;
+	entry.m_accuracy = CArea::m_accuracy;
+	entry.m_units = CArea::m_units;
+	entry.m_fit_arcs = CArea::m_fit_arcs;
+	entry.m_arc_booleans = CArea::m_arc_booleans;
+	entry.m_strips = CArea::m_strips;
+	entry.m_strip_min_vertices = CArea::m_strip_min_vertices;
+	entry.m_input.m_curves.swap(m_input.m_curves);
+	entry.m_input2.m_curves.swap(m_input2.m_curves);
+	entry.m_result.m_curves = m_area.m_curves;
+	cache_index.insert(std::make_pair(m_hash, cache_entries.begin()));
+
+	RemoveLeastRecentlyUsed();
+}
@@ -0,0 +1,40 @@
+// AreaCache.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "Area.h"
+
+class CAreaCacheLookup
+{
+	// make one of these at the start of Offset or a boolean
+	// if the cache is on and already has the result of the same operation on the same geometry, with the same settings,
+	// Found() puts the result in the area, otherwise call Store() when the operation has finished
+	// the cache is shared by all threads, and keeps up to CArea::GetCacheSize() results, dropping the least recently used
+	CArea &m_area;
+	bool m_use_cache;
+	int m_operation;
+	double m_value;
+	unsigned long long m_hash;
+	CArea m_input; // copies of the operands, so a matching hash can be checked
+	CArea m_input2;
+
+public:
+	enum
+	{
+		SubtractOperation,
+		IntersectOperation,
+		UnionOperation,
+		OffsetOperation,
+	};
+
+	CAreaCacheLookup(CArea &area, int operation, const CArea* a2, double value = 0.0);
+
+	bool Found();
+	void Store();
+};
+
+unsigned long long GetGeometryHash(const CCurve& curve); // curves with different hashes can't have the same geometry
+unsigned long long GetGeometryHash(const CArea& area);
+bool SameGeometry(const CCurve& c1, const CCurve& c2); // exactly the same vertices, not within tolerance like Point's ==
+bool SameGeometry(const CArea& a1, const CArea& a2);
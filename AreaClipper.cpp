@@ -3,13 +3,22 @@
 // implements CArea methods using Angus Johnson's "Clipper"
 
 #include "Area.h"
+#include "AreaCache.h"
+#include "AreaArcBoolean.h"
+#include "AreaStrips.h"
+#include "AreaStats.h"
+#include "AreaTrace.h"
 #include "clipper.hpp"
+#include <algorithm>
 using namespace clipper;
 
 #define TPolygon Polygon
 #define TPolyPolygon Polygons
 
 bool CArea::HolesLinked(){ return false; }
+size_t CAreaStats::EngineBytesInUse(){ return 0; }
+size_t CAreaStats::EnginePeakBytes(){ return 0; }
+void CAreaStats::SetEnginePeakBytes(size_t bytes){}
 
 static const double PI = 3.1415926535897932;
 static double Clipper4Factor = 10000.0;
@@ -24,7 +33,7 @@ public:
 	IntPoint int_point(){return IntPoint((long64)(X * Clipper4Factor), (long64)(Y * Clipper4Factor));}
 };
 
-static std::list<DoublePoint> pts_for_AddVertex;
+static thread_local std::list<DoublePoint> pts_for_AddVertex;
 
 static void AddPoint(const DoublePoint& p)
 {
@@ -312,8 +321,135 @@ static void SetFromResult( CArea& area, const TPolyPolygon& pp, bool reverse = t
     }
 }
 
+static int PointInPolygon(const IntPoint &pt, const TPolygon& p)
+{
+	// returns 0 if pt is outside p, 1 if it's inside and -1 if it's on p
+	int result = 0;
+	unsigned int s = p.size();
+	if(s < 3)return 0;
+	IntPoint ip = p[s-1];
+	for(unsigned int i = 0; i<s; i++)
+	{
+		const IntPoint &ip_next = p[i];
+		if(ip_next.Y == pt.Y && (ip_next.X == pt.X || (ip.Y == pt.Y && ((ip_next.X > pt.X) == (ip.X < pt.X)))))return -1;
+		if((ip.Y < pt.Y) != (ip_next.Y < pt.Y))
+		{
+			if(ip.X >= pt.X && ip_next.X > pt.X)result = 1 - result;
+			else if(ip.X >= pt.X || ip_next.X > pt.X)
+			{
+				double d = (double)(ip.X - pt.X) * (double)(ip_next.Y - pt.Y) - (double)(ip_next.X - pt.X) * (double)(ip.Y - pt.Y);
+				if(d == 0.0)return -1;
+				if((d > 0.0) == (ip_next.Y > ip.Y))result = 1 - result;
+			}
+		}
+		ip = ip_next;
+	}
+	return result;
+}
+
+class PolygonInResult
+{
+public:
+	const TPolygon* m_p;
+	double m_area;
+	IntPoint m_min, m_max;
+
+	PolygonInResult(const TPolygon* p):m_p(p)
+	{
+		m_area = 0.0;
+		m_min = m_max = (*p)[0];
+		for(unsigned int i = 0; i<p->size(); i++)
+		{
+			const IntPoint &pt = (*p)[i];
+			const IntPoint &prev = (*p)[(i == 0) ? (p->size() - 1) : (i - 1)];
+			m_area += 0.5 * ((double)pt.X - (double)prev.X) * ((double)prev.Y + (double)pt.Y);
+			if(pt.X < m_min.X)m_min.X = pt.X;
+			if(pt.X > m_max.X)m_max.X = pt.X;
+			if(pt.Y < m_min.Y)m_min.Y = pt.Y;
+			if(pt.Y > m_max.Y)m_max.Y = pt.Y;
+		}
+	}
+
+	bool operator<(const PolygonInResult& p)const{ return fabs(m_area) > fabs(p.m_area); } // largest first
+
+	bool Inside(const PolygonInResult& outer)const
+	{
+		if(m_min.X < outer.m_min.X || m_max.X > outer.m_max.X || m_min.Y < outer.m_min.Y || m_max.Y > outer.m_max.Y)return false;
+
+		// the polygons of a result don't cross, so the first point not touching outer decides
+		for(unsigned int i = 0; i<m_p->size(); i++)
+		{
+			int res = PointInPolygon((*m_p)[i], *(outer.m_p));
+			if(res >= 0)return res == 1;
+		}
+		return false;
+	}
+};
+
+static void SetFromResultInOrder( CArea& area, const TPolyPolygon& pp, bool reverse = true )
+{
+	// clipper has already made the outers and holes go opposite ways round, so instead of a Reorder,
+	// just give each hole to the smallest outer containing it, and put the outers, largest first, before their holes
+	area.m_curves.clear();
+
+	std::vector<PolygonInResult> polygons;
+	for(unsigned int i = 0; i < pp.size(); i++)
+	{
+		if(pp[i].size() > 2)polygons.push_back(PolygonInResult(&pp[i]));
+	}
+	if(polygons.size() == 0)return;
+	std::stable_sort(polygons.begin(), polygons.end());
+
+	// the largest polygon must be an outer
+	bool outer_area_positive = polygons[0].m_area > 0.0;
+	std::vector<unsigned int> outers;
+	std::vector< std::list<unsigned int> > holes;
+	std::list<unsigned int> lost_holes;
+	for(unsigned int i = 0; i < polygons.size(); i++)
+	{
+		if((polygons[i].m_area > 0.0) == outer_area_positive)
+		{
+			outers.push_back(i);
+			holes.push_back(std::list<unsigned int>());
+			continue;
+		}
+
+		// the outers so far are all larger, so search the smallest first
+		int j = (int)outers.size() - 1;
+		for(; j >= 0; j--)
+		{
+			if(polygons[i].Inside(polygons[outers[j]]))break;
+		}
+		if(j >= 0)holes[j].push_back(i);
+		else lost_holes.push_back(i); // shouldn't happen, but keep it anyway
+	}
+
+	for(unsigned int j = 0; j < outers.size(); j++)
+	{
+		area.m_curves.push_back(CCurve());
+		SetFromResult(area.m_curves.back(), *(polygons[outers[j]].m_p), reverse);
+		for(std::list<unsigned int>::iterator It = holes[j].begin(); It != holes[j].end(); It++)
+		{
+			area.m_curves.push_back(CCurve());
+			SetFromResult(area.m_curves.back(), *(polygons[*It].m_p), reverse);
+		}
+	}
+	for(std::list<unsigned int>::iterator It = lost_holes.begin(); It != lost_holes.end(); It++)
+	{
+		area.m_curves.push_back(CCurve());
+		SetFromResult(area.m_curves.back(), *(polygons[*It].m_p), reverse);
+	}
+}
+
 void CArea::Subtract(const CArea& a2)
 {
+	CAreaStatsScope stats(CAreaStats::BooleanOperation, *this, &a2);
+	CAreaTraceScope trace("Subtract");
+	CAreaCacheLookup cache(*this, CAreaCacheLookup::SubtractOperation, &a2);
+	if(cache.Found())return;
+	if(CAreaArcBoolean::Do(*this, CAreaArcBoolean::SubtractOperation, &a2)){cache.Store(); return;}
+	if(CAreaStrips::Do(*this, CAreaStrips::SubtractOperation, &a2)){cache.Store(); return;}
+
 	Clipper c;
 	TPolyPolygon pp1, pp2;
 	MakePolyPoly(*this, pp1);
@@ -322,11 +458,19 @@ void CArea::Subtract(const CArea& a2)
 	c.AddPolygons(pp2, ptClip);
 	TPolyPolygon solution;
 	c.Execute(ctDifference, solution);
-	SetFromResult(*this, solution);
+	SetFromResultInOrder(*this, solution);
+	cache.Store();
 }
 
 void CArea::Intersect(const CArea& a2)
 {
+	CAreaStatsScope stats(CAreaStats::BooleanOperation, *this, &a2);
+	CAreaTraceScope trace("Intersect");
+	CAreaCacheLookup cache(*this, CAreaCacheLookup::IntersectOperation, &a2);
+	if(cache.Found())return;
+	if(CAreaArcBoolean::Do(*this, CAreaArcBoolean::IntersectOperation, &a2)){cache.Store(); return;}
+	if(CAreaStrips::Do(*this, CAreaStrips::IntersectOperation, &a2)){cache.Store(); return;}
+
 	Clipper c;
 	TPolyPolygon pp1, pp2;
 	MakePolyPoly(*this, pp1);
@@ -335,11 +479,19 @@ void CArea::Intersect(const CArea& a2)
 	c.AddPolygons(pp2, ptClip);
 	TPolyPolygon solution;
 	c.Execute(ctIntersection, solution);
-	SetFromResult(*this, solution);
+	SetFromResultInOrder(*this, solution);
+	cache.Store();
 }
 
 void CArea::Union(const CArea& a2)
 {
+	CAreaStatsScope stats(CAreaStats::BooleanOperation, *this, &a2);
+	CAreaTraceScope trace("Union");
+	CAreaCacheLookup cache(*this, CAreaCacheLookup::UnionOperation, &a2);
+	if(cache.Found())return;
+	if(CAreaArcBoolean::Do(*this, CAreaArcBoolean::UnionOperation, &a2)){cache.Store(); return;}
+	if(CAreaStrips::Do(*this, CAreaStrips::UnionOperation, &a2)){cache.Store(); return;}
+
 	Clipper c;
 	TPolyPolygon pp1, pp2;
 	MakePolyPoly(*this, pp1);
@@ -348,16 +500,28 @@ void CArea::Union(const CArea& a2)
 	c.AddPolygons(pp2, ptClip);
 	TPolyPolygon solution;
 	c.Execute(ctUnion, solution);
-	SetFromResult(*this, solution);
+	SetFromResultInOrder(*this, solution);
+	cache.Store();
 }
 
 void CArea::Offset(double inwards_value)
 {
+	CAreaStatsScope stats(CAreaStats::OffsetOperation, *this);
+	CAreaTraceScope trace("Offset");
+	if(m_simplify_tolerance > 0.0)Simplify(m_simplify_tolerance / m_units);
+	CAreaCacheLookup cache(*this, CAreaCacheLookup::OffsetOperation, NULL, inwards_value);
+	if(cache.Found())return;
+	if(CAreaArcBoolean::Do(*this, CAreaArcBoolean::OffsetOperation, NULL, inwards_value)){cache.Store(); return;}
+	if(CAreaStrips::Do(*this, CAreaStrips::OffsetOperation, NULL, inwards_value)){cache.Store(); return;}
+
 	TPolyPolygon pp, pp2;
 	MakePolyPoly(*this, pp, false);
 	OffsetWithLoops(pp, pp2, inwards_value * m_units);
-	SetFromResult(*this, pp2, false);
-	this->Reorder();
+	SetFromResultInOrder(*this, pp2, false);
+
+	// the loops leave every curve the wrong way round
+	for(std::list<CCurve>::iterator It = m_curves.begin(); It != m_curves.end(); It++)It->Reverse();
+	cache.Store();
 }
 
 void UnFitArcs(CCurve &curve)
@@ -379,4 +543,5 @@ void UnFitArcs(CCurve &curve)
 		CVertex vertex(0, Point(pt.X / CArea::m_units, pt.Y / CArea::m_units), Point(0.0, 0.0));
 		curve.m_vertices.push_back(vertex);
 	}
+	curve.VerticesChanged();
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+// AreaIncrementalPocket.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CAreaIncrementalPocket, SplitAndMakePocketToolpath which only pockets the regions that have changed
+
+#include "AreaIncrementalPocket.h"
+#include "AreaCache.h"
+#include <algorithm>
+#include <map>
+
+void CAreaIncrementalPocket::Region::SetArea(CArea &area)
+{
+	m_area.m_curves.swap(area.m_curves);
+	m_area.GetBox(m_box);
+
+	m_curve_hashes.clear();
+	for(std::list<CCurve>::const_iterator It = m_area.m_curves.begin(); It != m_area.m_curves.end(); It++)
+		m_curve_hashes.push_back(GetGeometryHash(*It));
+	if(m_curve_hashes.size() > 1)std::sort(m_curve_hashes.begin() + 1, m_curve_hashes.end());
+
+	m_hash = 14695981039346656037ULL;
+	for(unsigned int i = 0; i < m_curve_hashes.size(); i++)
+	{
+		m_hash ^= m_curve_hashes[i];
+		m_hash *= 1099511628211ULL;
+	}
+}
+
+bool CAreaIncrementalPocket::Region::SameGeometry(const Region &region)const
+{
+	if(m_hash != region.m_hash || m_box != region.m_box || m_curve_hashes != region.m_curve_hashes)return false;
+	if(m_area.m_curves.size() == 0)return true;
+	if(!::SameGeometry(m_area.m_curves.front(), region.m_area.m_curves.front()))return false;
+
+	// match each hole with one of the same hash
+	std::multimap<unsigned long long, const CCurve*> holes;
+	std::list<CCurve>::const_iterator It = region.m_area.m_curves.begin();
+	for(It++; It != region.m_area.m_curves.end(); It++)
+		holes.insert(std::make_pair(GetGeometryHash(*It), &(*It)));
+
+	It = m_area.m_curves.begin();
+	for(It++; It != m_area.m_curves.end(); It++)
+	{
+		bool found = false;
+		std::pair<std::multimap<unsigned long long, const CCurve*>::iterator, std::multimap<unsigned long long, const CCurve*>::iterator> range = holes.equal_range(GetGeometryHash(*It));
+		for(std::multimap<unsigned long long, const CCurve*>::iterator It2 = range.first; It2 != range.second; It2++)
+		{
+			if(::SameGeometry(*It, *(It2->second)))
+			{
+				holes.erase(It2);
+				found = true;
+				break;
+			}
+		}
+		if(!found)return false;
+	}
+	return true;
+}
+
+CAreaIncrementalPocket::CAreaIncrementalPocket(const CAreaPocketParams &params):m_params(params), m_accuracy(0.0), m_units(0.0), m_fit_arcs(false), m_simplify_tolerance(0.0), m_arc_booleans(false), m_strips(0), m_strip_min_vertices(0), m_regions_made(0), m_regions_kept(0)
+{
+}
+
+void CAreaIncrementalPocket::Clear()
+{
+	m_regions.clear();
+}
+
+void CAreaIncrementalPocket::MakePocketToolpath(const CArea &area, std::list<CCurve> &toolpath)
+{
+	if(m_accuracy != CArea::m_accuracy || m_units != CArea::m_units || m_fit_arcs != CArea::m_fit_arcs || m_simplify_tolerance != CArea::m_simplify_tolerance
+		|| m_arc_booleans != CArea::m_arc_booleans || m_strips != CArea::m_strips || m_strip_min_vertices != CArea::m_strip_min_vertices)
+	{
+		Clear();
+		m_accuracy = CArea::m_accuracy;
+		m_units = CArea::m_units;
+		m_fit_arcs = CArea::m_fit_arcs;
+		m_simplify_tolerance = CArea::m_simplify_tolerance;
+		m_arc_booleans = CArea::m_arc_booleans;
+		m_strips = CArea::m_strips;
+		m_strip_min_vertices = CArea::m_strip_min_vertices;
+	}
+
+	m_regions_made = 0;
+	m_regions_kept = 0;
+	m_changed_box = CAreaBox();
+
+	// split the area into regions, as SplitAndMakePocketToolpath does
+	CArea::m_progress->m_processing_done = 0.0;
+
+	double save_units = CArea::m_units;
+	CArea::m_units = 1.0;
+	std::list<CArea> areas;
+	CArea::m_progress->m_split_processing_length = 50.0; // jump to 50 percent after split
+	CArea::m_progress->m_set_processing_length_in_split = true;
+	area.Split(areas);
+	CArea::m_progress->m_set_processing_length_in_split = false;
+	CArea::m_progress->m_processing_done = CArea::m_progress->m_split_processing_length;
+	CArea::m_progress->Update();
+	CArea::m_units = save_units;
+	if(CArea::m_progress->m_please_abort)return;
+
+	// the regions from last time, which haven't been matched yet, by hash
+	std::multimap<unsigned long long, std::list<Region>::iterator> old_regions;
+	for(std::list<Region>::iterator It = m_regions.begin(); It != m_regions.end(); It++)
+		old_regions.insert(std::make_pair(It->m_hash, It));
+
+	double single_area_length = areas.size() > 0 ? 50.0 / areas.size() : 0.0;
+
+	std::list<Region> regions;
+	for(std::list<CArea>::iterator It = areas.begin(); It != areas.end(); It++)
+	{
+		regions.push_back(Region());
+		Region &region = regions.back();
+		region.SetArea(*It);
+
+		// look for the same region last time
+		bool kept = false;
+		std::pair<std::multimap<unsigned long long, std::list<Region>::iterator>::iterator, std::multimap<unsigned long long, std::list<Region>::iterator>::iterator> range = old_regions.equal_range(region.m_hash);
+		for(std::multimap<unsigned long long, std::list<Region>::iterator>::iterator It2 = range.first; It2 != range.second; It2++)
+		{
+			const Region &old_region = *(It2->second);
+			if(region.SameGeometry(old_region))
+			{
+				region.m_toolpath = old_region.m_toolpath; // copied, so an abort leaves the old regions as they were
+				old_regions.erase(It2);
+				kept = true;
+				break;
+			}
+		}
+
+		if(kept)
+		{
+			m_regions_kept++;
+			CArea::m_progress->AddProcessingDone(single_area_length);
+		}
+		else
+		{
+			CArea::m_progress->m_single_area_processing_length = single_area_length;
+			region.m_area.MakePocketToolpath(region.m_toolpath, m_params);
+			if(CArea::m_progress->m_please_abort)return;
+			m_regions_made++;
+			m_changed_box.Insert(region.m_box);
+		}
+
+		CArea::m_progress->Update();
+		if(CArea::m_progress->m_listener)CArea::m_progress->m_listener->OnRegionToolpath(region.m_toolpath);
+		toolpath.insert(toolpath.end(), region.m_toolpath.begin(), region.m_toolpath.end());
+	}
+
+	// the regions left over from last time have gone
+	for(std::multimap<unsigned long long, std::list<Region>::iterator>::iterator It = old_regions.begin(); It != old_regions.end(); It++)
+		m_changed_box.Insert(It->second->m_box);
+
+	m_regions.swap(regions);
+}
@@ -0,0 +1,48 @@
+// AreaIncrementalPocket.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "Area.h"
+#include <vector>
+
+class CAreaIncrementalPocket
+{
+	// makes pocket toolpaths like SplitAndMakePocketToolpath, but keeps each region and its toolpath for the next time
+	// when the area has been edited, only the regions which aren't exactly the same as last time are pocketed again
+	// so moving one island only redoes the region it was in and the region it has moved to
+	class Region
+	{
+	public:
+		CArea m_area;
+		CAreaBox m_box;
+		std::vector<unsigned long long> m_curve_hashes; // the outer's, then the holes' sorted, as Split can give the holes in any order
+		unsigned long long m_hash; // of m_curve_hashes
+		std::list<CCurve> m_toolpath;
+
+		void SetArea(CArea &area); // moves the curves in
+		bool SameGeometry(const Region &region)const;
+	};
+
+	CAreaPocketParams m_params;
+	std::list<Region> m_regions; // in the order of the last toolpath
+	double m_accuracy; // the settings the regions were pocketed with, if they change all the regions are done again
+	double m_units;
+	bool m_fit_arcs;
+	double m_simplify_tolerance;
+	bool m_arc_booleans;
+	unsigned int m_strips;
+	unsigned int m_strip_min_vertices;
+	unsigned int m_regions_made;
+	unsigned int m_regions_kept;
+	CAreaBox m_changed_box;
+
+public:
+	CAreaIncrementalPocket(const CAreaPocketParams &params);
+
+	void MakePocketToolpath(const CArea &area, std::list<CCurve> &toolpath); // uses CArea::m_progress, like SplitAndMakePocketToolpath
+	void Clear(); // forget the regions, so they are all done again
+	unsigned int NumRegionsMade()const{return m_regions_made;} // regions pocketed by the last MakePocketToolpath
+	unsigned int NumRegionsKept()const{return m_regions_kept;} // regions whose toolpath was kept from the time before
+	const CAreaBox& ChangedBox()const{return m_changed_box;} // around the regions made and the regions gone, by the last MakePocketToolpath
+};
@@ -4,10 +4,11 @@
 
 #include "AreaOrderer.h"
 #include "Area.h"
+#include <utility>
 
-CAreaOrderer* CInnerCurves::area_orderer = NULL;
+thread_local CAreaOrderer* CInnerCurves::area_orderer = NULL;
 
-CInnerCurves::CInnerCurves(CInnerCurves* pOuter, const CCurve* curve)
+CInnerCurves::CInnerCurves(CInnerCurves* pOuter, CCurve* curve)
 {
 	m_pOuter = pOuter;
 	m_curve = curve;
@@ -19,7 +20,7 @@ CInnerCurves::~CInnerCurves()
 	delete m_unite_area;
 }
 
-void CInnerCurves::Insert(const CCurve* pcurve)
+void CInnerCurves::Insert(CCurve* pcurve)
 {
 	std::list<CInnerCurves*> outside_of_these;
 	std::list<CInnerCurves*> crossing_these;
@@ -71,38 +72,39 @@ void CInnerCurves::Insert(const CCurve* pcurve)
 	}
 }
 
-void CInnerCurves::GetArea(CArea &area, bool outside, bool use_curve)const
+void CInnerCurves::GetArea(CArea &area, bool outside, bool use_curve)
 {
 	if(use_curve && m_curve)
 	{
-		area.m_curves.push_back(*m_curve);
+		area.m_curves.push_back(std::move(*m_curve));
 		outside = !outside;
 	}
 
-	std::list<const CInnerCurves*> do_after;
+	std::list<CInnerCurves*> do_after;
 
-	for(std::set<CInnerCurves*>::const_iterator It = m_inner_curves.begin(); It != m_inner_curves.end(); It++)
+	for(std::set<CInnerCurves*>::iterator It = m_inner_curves.begin(); It != m_inner_curves.end(); It++)
 	{
-		const CInnerCurves* c = *It;
-		area.m_curves.push_back(*c->m_curve);
+		CInnerCurves* c = *It;
+		area.m_curves.push_back(std::move(*c->m_curve));
 		if(!outside)area.m_curves.back().Reverse();
 
 		if(outside)c->GetArea(area, !outside, false);
 		else do_after.push_back(c);
 	}
 
-	for(std::list<const CInnerCurves*>::iterator It = do_after.begin(); It != do_after.end(); It++)
+	for(std::list<CInnerCurves*>::iterator It = do_after.begin(); It != do_after.end(); It++)
 	{
-		const CInnerCurves* c = *It;
+		CInnerCurves* c = *It;
 		c->GetArea(area, !outside, false);
 	}
 }
 
-void CInnerCurves::Unite(const CInnerCurves* c)
+void CInnerCurves::Unite(CInnerCurves* c)
 {
 	// unite all the curves in c, with this one
+	// c is finished with after this, so its curves are moved, not copied
 	CArea* new_area = new CArea();
-	new_area->m_curves.push_back(*m_curve);
+	new_area->m_curves.push_back(std::move(*m_curve));
 	delete m_unite_area;
 	m_unite_area = new_area;
 
@@ -110,17 +112,15 @@ void CInnerCurves::Unite(const CInnerCurves* c)
 	c->GetArea(a2);
 
 	m_unite_area->Union(a2);
-	m_unite_area->Reorder();
+	if(CArea::HolesLinked())m_unite_area->Reorder(); // else Union has already put the largest outer first
 	for(std::list<CCurve>::iterator It = m_unite_area->m_curves.begin(); It != m_unite_area->m_curves.end(); It++)
 	{
 		CCurve &curve = *It;
+		if(curve.IsClockwise())curve.Reverse();
 		if(It == m_unite_area->m_curves.begin())
 			m_curve = &curve;
 		else
-		{
-			if(curve.IsClockwise())curve.Reverse();
 			Insert(&curve);
-		}
 	}
 }
 
@@ -139,15 +139,11 @@ void CAreaOrderer::Insert(CCurve* pcurve)
 	m_top_level->Insert(pcurve);
 }
 
-CArea CAreaOrderer::ResultArea()const
+void CAreaOrderer::ResultArea(CArea &area)
 {
-	CArea a;
-
 	if(m_top_level)
 	{
-		m_top_level->GetArea(a);
+		m_top_level->GetArea(area);
 	}
-
-	return a;
 }
 
@@ -15,17 +15,17 @@ class CInnerCurves
 {
 public:
 	CInnerCurves* m_pOuter;
-	const CCurve* m_curve; // always empty if top level
+	CCurve* m_curve; // always empty if top level
 	std::set<CInnerCurves*> m_inner_curves;
 	CArea *m_unite_area; // new curves made by uniting are stored here
 
-	static CAreaOrderer* area_orderer;
-	CInnerCurves(CInnerCurves* pOuter, const CCurve* curve);
+	static thread_local CAreaOrderer* area_orderer;
+	CInnerCurves(CInnerCurves* pOuter, CCurve* curve);
 	~CInnerCurves();
 
-	void Insert(const CCurve* pcurve);
-	void GetArea(CArea &area, bool outside = true, bool use_curve = true)const;
-	void Unite(const CInnerCurves* c);
+	void Insert(CCurve* pcurve);
+	void GetArea(CArea &area, bool outside = true, bool use_curve = true); // moves the curves into area, so only do it once
+	void Unite(CInnerCurves* c);
 };
 
 class CAreaOrderer
@@ -36,5 +36,5 @@ public:
 	CAreaOrderer();
 
 	void Insert(CCurve* pcurve);
-	CArea ResultArea()const;
+	void ResultArea(CArea &area); // moves the inserted curves into area, in order
 };
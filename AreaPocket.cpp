@@ -5,11 +5,16 @@
 // implements CArea::MakeOnePocketCurve
 
 #include "Area.h"
+#include "AreaTrace.h"
 
 #include <map>
 #include <set>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <utility>
 
-static const CAreaPocketParams* pocket_params = NULL;
+static thread_local const CAreaPocketParams* pocket_params = NULL;
 
 class IslandAndOffset
 {
@@ -18,35 +23,42 @@ public:
 	CArea offset;
 	std::list<CCurve> island_inners;
 	std::list<IslandAndOffset*> touching_offsets;
+	CAreaBox box; // of offset
 
 	IslandAndOffset(const CCurve* Island)
 	{
 		island = Island;
+	}
 
+	void MakeOffset(double stepover)
+	{
 		offset.m_curves.push_back(*island);
 		offset.m_curves.back().Reverse();
 
-		offset.Offset(-pocket_params->stepover);
+		offset.Offset(-stepover);
 
 
 		if(offset.m_curves.size() > 1)
 		{
-			for(std::list<CCurve>::iterator It = offset.m_curves.begin(); It != offset.m_curves.end(); It++)
+			// move all but the first curve to island_inners
+			std::list<CCurve>::iterator FirstIt = offset.m_curves.begin();
+			FirstIt++;
+			island_inners.splice(island_inners.end(), offset.m_curves, FirstIt, offset.m_curves.end());
+			for(std::list<CCurve>::iterator It = island_inners.begin(); It != island_inners.end(); It++)
 			{
-				if(It == offset.m_curves.begin())continue;
-				island_inners.push_back(*It);
-				island_inners.back().Reverse();
+				It->Reverse();
 			}
-			offset.m_curves.resize(1);
 		}
+
+		offset.GetBox(box);
 	}
 };
 
 class CurveTree
 {
-	static std::list<CurveTree*> to_do_list_for_MakeOffsets;
+	static thread_local std::list<CurveTree*> to_do_list_for_MakeOffsets;
 	void MakeOffsets2();
-	static std::list<CurveTree*> islands_added;
+	static thread_local std::list<CurveTree*> islands_added;
 
 public:
 	Point point_on_parent;
@@ -61,14 +73,14 @@ public:
 
 	void MakeOffsets();
 };
-std::list<CurveTree*> CurveTree::islands_added;
+thread_local std::list<CurveTree*> CurveTree::islands_added;
 
 class GetCurveItem
 {
 public:
 	CurveTree* curve_tree;
 	std::list<CVertex>::iterator EndIt;
-	static std::list<GetCurveItem> to_do_list;
+	static thread_local std::list<GetCurveItem> to_do_list;
 
 	GetCurveItem(CurveTree* ct, std::list<CVertex>::iterator EIt):curve_tree(ct), EndIt(EIt){}
 
@@ -76,8 +88,8 @@ public:
 	CVertex& back(){std::list<CVertex>::iterator It = EndIt; It--; return *It;}
 };
 
-std::list<GetCurveItem> GetCurveItem::to_do_list;
-std::list<CurveTree*> CurveTree::to_do_list_for_MakeOffsets;
+thread_local std::list<GetCurveItem> GetCurveItem::to_do_list;
+thread_local std::list<CurveTree*> CurveTree::to_do_list_for_MakeOffsets;
 
 void GetCurveItem::GetCurve(CCurve& output)
 {
@@ -85,7 +97,7 @@ void GetCurveItem::GetCurve(CCurve& output)
 	// then add a line from the inner's point_on_parent to inner's start point, then GetCurve from inner
 
 	// add start point
-	if(CArea::m_please_abort)return;
+	if(CArea::m_progress->m_please_abort)return;
 	output.m_vertices.insert(this->EndIt, CVertex(curve_tree->curve.m_vertices.front()));
 
 	std::list<CurveTree*> inners_to_visit;
@@ -118,10 +130,10 @@ void GetCurveItem::GetCurve(CCurve& output)
 				{
 					It2++;
 				}
-				if(CArea::m_please_abort)return;
+				if(CArea::m_progress->m_please_abort)return;
 			}
 
-			if(CArea::m_please_abort)return;
+			if(CArea::m_progress->m_please_abort)return;
 			for(std::multimap<double, CurveTree*>::iterator It2 = ordered_inners.begin(); It2 != ordered_inners.end(); It2++)
 			{
 				CurveTree& inner = *(It2->second);
@@ -129,7 +141,7 @@ void GetCurveItem::GetCurve(CCurve& output)
 				{
 					output.m_vertices.insert(this->EndIt, CVertex(vertex.m_type, inner.point_on_parent, vertex.m_c));
 				}
-				if(CArea::m_please_abort)return;
+				if(CArea::m_progress->m_please_abort)return;
 
 				// vertex add after GetCurve
 				std::list<CVertex>::iterator VIt = output.m_vertices.insert(this->EndIt, CVertex(inner.point_on_parent));
@@ -143,7 +155,7 @@ void GetCurveItem::GetCurve(CCurve& output)
 		prev_vertex = &vertex;
 	}
 
-	if(CArea::m_please_abort)return;
+	if(CArea::m_progress->m_please_abort)return;
 	for(std::list<CurveTree*>::iterator It2 = inners_to_visit.begin(); It2 != inners_to_visit.end(); It2++)
 	{
 		CurveTree &inner = *(*It2);
@@ -151,7 +163,7 @@ void GetCurveItem::GetCurve(CCurve& output)
 		{
 			output.m_vertices.insert(this->EndIt, CVertex(inner.point_on_parent));
 		}
-		if(CArea::m_please_abort)return;
+		if(CArea::m_progress->m_please_abort)return;
 
 		// vertex add after GetCurve
 		std::list<CVertex>::iterator VIt = output.m_vertices.insert(this->EndIt, CVertex(inner.point_on_parent));
@@ -174,13 +186,13 @@ static Point GetNearestPoint(CurveTree* curve_tree, std::list<CurveTree*> &islan
 {
 	// find nearest point to test_curve, from curve and all the islands in 
 	double best_dist;
-	Point best_point = curve_tree->curve.NearestPoint(test_curve, &best_dist);
+	Point best_point = curve_tree->curve.SpanIndex().NearestPoint(test_curve, &best_dist);
 	*best_curve_tree = curve_tree;
 	for(std::list<CurveTree*>::iterator It = islands_added.begin(); It != islands_added.end(); It++)
 	{
 		CurveTree* island = *It;
 		double dist;
-		Point p = island->curve.NearestPoint(test_curve, &dist);
+		Point p = island->curve.SpanIndex().NearestPoint(test_curve, &dist);
 		if(dist < best_dist)
 		{
 			*best_curve_tree = island;
@@ -194,14 +206,15 @@ static Point GetNearestPoint(CurveTree* curve_tree, std::list<CurveTree*> &islan
 
 void CurveTree::MakeOffsets2()
 {
+	CAreaTraceScope trace("CurveTree::MakeOffsets2");
 	// make offsets
 
-	if(CArea::m_please_abort)return;
+	if(CArea::m_progress->m_please_abort)return;
 	CArea smaller;
 	smaller.m_curves.push_back(curve);
 	smaller.Offset(pocket_params->stepover);
 
-	if(CArea::m_please_abort)return;
+	if(CArea::m_progress->m_please_abort)return;
 
 	// test islands
 	for(std::list<const IslandAndOffset*>::iterator It = offset_islands.begin(); It != offset_islands.end();)
@@ -214,25 +227,25 @@ void CurveTree::MakeOffsets2()
 		{
 			inners.push_back(new CurveTree(*island_and_offset->island));
 			islands_added.push_back(inners.back());
-			inners.back()->point_on_parent = curve.NearestPoint(*island_and_offset->island);
-			if(CArea::m_please_abort)return;
+			inners.back()->point_on_parent = curve.SpanIndex().NearestPoint(*island_and_offset->island); // curve is tested against each island, so index its spans
+			if(CArea::m_progress->m_please_abort)return;
 			Point island_point = island_and_offset->island->NearestPoint(inners.back()->point_on_parent);
-			if(CArea::m_please_abort)return;
+			if(CArea::m_progress->m_please_abort)return;
 			inners.back()->curve.ChangeStart(island_point);
-			if(CArea::m_please_abort)return;
+			if(CArea::m_progress->m_please_abort)return;
 
 			// add the island offset's inner curves
 			for(std::list<CCurve>::const_iterator It2 = island_and_offset->island_inners.begin(); It2 != island_and_offset->island_inners.end(); It2++)
 			{
 				const CCurve& island_inner = *It2;
 				inners.back()->inners.push_back(new CurveTree(island_inner));
-				inners.back()->inners.back()->point_on_parent = inners.back()->curve.NearestPoint(island_inner);
-				if(CArea::m_please_abort)return;
+				inners.back()->inners.back()->point_on_parent = inners.back()->curve.SpanIndex().NearestPoint(island_inner);
+				if(CArea::m_progress->m_please_abort)return;
 				Point island_point = island_inner.NearestPoint(inners.back()->inners.back()->point_on_parent);
-				if(CArea::m_please_abort)return;
+				if(CArea::m_progress->m_please_abort)return;
 				inners.back()->inners.back()->curve.ChangeStart(island_point);
 				to_do_list_for_MakeOffsets.push_back(inners.back()->inners.back()); // do it later, in a while loop
-				if(CArea::m_please_abort)return;
+				if(CArea::m_progress->m_please_abort)return;
 			}
 
 			smaller.Subtract(island_and_offset->offset);
@@ -253,7 +266,7 @@ void CurveTree::MakeOffsets2()
 				touching_list.pop_front();
 				touching.add_to->inners.push_back(new CurveTree(*touching.island_and_offset->island));
 				islands_added.push_back(touching.add_to->inners.back());
-				touching.add_to->inners.back()->point_on_parent = touching.add_to->curve.NearestPoint(*touching.island_and_offset->island);
+				touching.add_to->inners.back()->point_on_parent = touching.add_to->curve.SpanIndex().NearestPoint(*touching.island_and_offset->island);
 				Point island_point = touching.island_and_offset->island->NearestPoint(touching.add_to->inners.back()->point_on_parent);
 				touching.add_to->inners.back()->curve.ChangeStart(island_point);
 				smaller.Subtract(touching.island_and_offset->offset);
@@ -263,13 +276,13 @@ void CurveTree::MakeOffsets2()
 				{
 					const CCurve& island_inner = *It2;
 					touching.add_to->inners.back()->inners.push_back(new CurveTree(island_inner));
-					touching.add_to->inners.back()->inners.back()->point_on_parent = touching.add_to->inners.back()->curve.NearestPoint(island_inner);
-					if(CArea::m_please_abort)return;
+					touching.add_to->inners.back()->inners.back()->point_on_parent = touching.add_to->inners.back()->curve.SpanIndex().NearestPoint(island_inner);
+					if(CArea::m_progress->m_please_abort)return;
 					Point island_point = island_inner.NearestPoint(touching.add_to->inners.back()->inners.back()->point_on_parent);
-					if(CArea::m_please_abort)return;
+					if(CArea::m_progress->m_please_abort)return;
 					touching.add_to->inners.back()->inners.back()->curve.ChangeStart(island_point);
 					to_do_list_for_MakeOffsets.push_back(touching.add_to->inners.back()->inners.back()); // do it later, in a while loop
-					if(CArea::m_please_abort)return;
+					if(CArea::m_progress->m_please_abort)return;
 				}
 
 				for(std::list<IslandAndOffset*>::const_iterator It2 = touching.island_and_offset->touching_offsets.begin(); It2 != touching.island_and_offset->touching_offsets.end(); It2++)
@@ -282,7 +295,7 @@ void CurveTree::MakeOffsets2()
 				}
 			}
 
-			if(CArea::m_please_abort)return;
+			if(CArea::m_progress->m_please_abort)return;
 			It = offset_islands.erase(It);
 
 			for(std::set<const IslandAndOffset*>::iterator It2 = added.begin(); It2 != added.end(); It2++)
@@ -296,12 +309,13 @@ void CurveTree::MakeOffsets2()
 		}
 	}
 
-	CArea::m_processing_done += CArea::m_MakeOffsets_increment;
-	if(CArea::m_processing_done > CArea::m_after_MakeOffsets_length)CArea::m_processing_done = CArea::m_after_MakeOffsets_length;
+	CArea::m_progress->AddProcessingDone(CArea::m_progress->m_MakeOffsets_increment);
+	if(CArea::m_progress->m_processing_done > CArea::m_progress->m_after_MakeOffsets_length)CArea::m_progress->m_processing_done = CArea::m_progress->m_after_MakeOffsets_length;
+	CArea::m_progress->Update();
 
 	std::list<CArea> separate_areas;
 	smaller.Split(separate_areas);
-	if(CArea::m_please_abort)return;
+	if(CArea::m_progress->m_please_abort)return;
 	for(std::list<CArea>::iterator It = separate_areas.begin(); It != separate_areas.end(); It++)
 	{
 		CArea& separate_area = *It;
@@ -317,18 +331,18 @@ void CurveTree::MakeOffsets2()
 			const IslandAndOffset* island_and_offset = *It;
 			if(GetOverlapType(island_and_offset->offset, separate_area) == eInside)
 				nearest_curve_tree->inners.back()->offset_islands.push_back(island_and_offset);
-			if(CArea::m_please_abort)return;
+			if(CArea::m_progress->m_please_abort)return;
 		}
 
 		nearest_curve_tree->inners.back()->point_on_parent = near_point;
 
-		if(CArea::m_please_abort)return;
+		if(CArea::m_progress->m_please_abort)return;
 		Point first_curve_point = first_curve.NearestPoint(nearest_curve_tree->inners.back()->point_on_parent);
-		if(CArea::m_please_abort)return;
+		if(CArea::m_progress->m_please_abort)return;
 		nearest_curve_tree->inners.back()->curve.ChangeStart(first_curve_point);
-		if(CArea::m_please_abort)return;
+		if(CArea::m_progress->m_please_abort)return;
 		to_do_list_for_MakeOffsets.push_back(nearest_curve_tree->inners.back()); // do it later, in a while loop
-		if(CArea::m_please_abort)return;
+		if(CArea::m_progress->m_please_abort)return;
 	}
 }
 
@@ -345,22 +359,23 @@ void CurveTree::MakeOffsets()
 	}
 }
 
-void recur(std::list<CArea> &arealist, const CArea& a1, const CAreaPocketParams &params, int level)
+void recur(std::list<CArea> &arealist, CArea&& a1, const CAreaPocketParams &params, int level)
 {
 	//if(level > 3)return;
 
     // this makes arealist by recursively offsetting a1 inwards
+    // a1 is moved into arealist
     
 	if(a1.m_curves.size() == 0)
 		return;
     
-	if(params.from_center)
-		arealist.push_front(a1);
-	else
-		arealist.push_back(a1);
-
     CArea a_offset = a1;
     a_offset.Offset(params.stepover);
+
+	if(params.from_center)
+		arealist.push_front(std::move(a1));
+	else
+		arealist.push_back(std::move(a1));
     
     // split curves into new areas
 	if(CArea::HolesLinked())
@@ -368,36 +383,36 @@ void recur(std::list<CArea> &arealist, const CArea& a1, const CAreaPocketParams
 		for(std::list<CCurve>::iterator It = a_offset.m_curves.begin(); It != a_offset.m_curves.end(); It++)
 		{
             CArea a2;
-			a2.m_curves.push_back(*It);
-            recur(arealist, a2, params, level + 1);
+			a2.m_curves.push_back(std::move(*It));
+            recur(arealist, std::move(a2), params, level + 1);
 		}
 	}
     else
 	{
-        // split curves into new areas
-		a_offset.Reorder();
-        CArea* a2 = NULL;
+        // split curves into new areas, Offset has already put each outer before its holes
+        CArea a2;
        
 		for(std::list<CCurve>::iterator It = a_offset.m_curves.begin(); It != a_offset.m_curves.end(); It++)
 		{
 			CCurve& curve = *It;
 			if(curve.IsClockwise())
 			{
-				if(a2 != NULL)
-					a2->m_curves.push_back(curve);
+				if(a2.m_curves.size() > 0)
+					a2.m_curves.push_back(std::move(curve));
 			}
 			else
 			{
-				if(a2 != NULL)
-					recur(arealist, *a2, params, level + 1);
-				else
-					a2 = new CArea();
-                a2->m_curves.push_back(curve);
+				if(a2.m_curves.size() > 0)
+				{
+					recur(arealist, std::move(a2), params, level + 1);
+					a2.m_curves.clear();
+				}
+                a2.m_curves.push_back(std::move(curve));
 			}
 		}
 
-		if(a2 != NULL)
-			recur(arealist, *a2, params, level + 1);
+		if(a2.m_curves.size() > 0)
+			recur(arealist, std::move(a2), params, level + 1);
 	}
 }
 
@@ -430,37 +445,89 @@ static bool feed_possible(const CArea &area_for_feed_possible, const Point& p0,
 	return obround.m_curves.size() == 0;
 }
 
+static void MakeIslandOffsets(std::list<IslandAndOffset> &offset_islands)
+{
+	// each island is offset on its own, so share them between threads
+	std::vector<IslandAndOffset*> islands;
+	for(std::list<IslandAndOffset>::iterator It = offset_islands.begin(); It != offset_islands.end(); It++)
+		islands.push_back(&(*It));
+
+	CAreaSettings settings;
+	double stepover = pocket_params->stepover;
+	std::exception_ptr error;
+	int n = (int)islands.size();
+
+#pragma omp parallel for schedule(dynamic)
+	for(int i = 0; i < n; i++)
+	{
+		settings.Apply();
+		if(CArea::m_progress->m_please_abort)continue;
+		try
+		{
+			islands[i]->MakeOffset(stepover);
+		}
+		catch(...)
+		{
+			// an exception mustn't leave the parallel loop, throw the first one after it
+#pragma omp critical
+			if(!error)error = std::current_exception();
+		}
+	}
+
+	if(error)std::rethrow_exception(error);
+}
+
 void MarkOverlappingOffsetIslands(std::list<IslandAndOffset> &offset_islands)
 {
-	for(std::list<IslandAndOffset>::iterator It1 = offset_islands.begin(); It1 != offset_islands.end(); It1++)
+	// offsets can only cross if their boxes overlap, so sweep the boxes along x to find those pairs
+	std::vector<IslandAndOffset*> islands;
+	std::vector< std::pair<double, unsigned int> > by_min_x;
+	for(std::list<IslandAndOffset>::iterator It = offset_islands.begin(); It != offset_islands.end(); It++)
 	{
-		std::list<IslandAndOffset>::iterator It2 = It1;
-		It2++;
-		for(;It2 != offset_islands.end(); It2++)
+		IslandAndOffset &o = *It;
+		if(o.box.m_valid)by_min_x.push_back(std::make_pair(o.box.MinX(), (unsigned int)islands.size()));
+		islands.push_back(&o);
+	}
+	std::sort(by_min_x.begin(), by_min_x.end());
+
+	double margin = CArea::m_accuracy; // don't miss boxes that only just touch
+	std::vector< std::pair<unsigned int, unsigned int> > pairs;
+	for(unsigned int i = 0; i < by_min_x.size(); i++)
+	{
+		const CAreaBox &b1 = islands[by_min_x[i].second]->box;
+		for(unsigned int j = i + 1; j < by_min_x.size() && by_min_x[j].first <= b1.MaxX() + margin; j++)
 		{
-			IslandAndOffset &o1 = *It1;
-			IslandAndOffset &o2 = *It2;
+			const CAreaBox &b2 = islands[by_min_x[j].second]->box;
+			if(b2.MinY() > b1.MaxY() + margin || b2.MaxY() < b1.MinY() - margin)continue;
+			pairs.push_back(std::make_pair(std::min(by_min_x[i].second, by_min_x[j].second), std::max(by_min_x[i].second, by_min_x[j].second)));
+		}
+	}
 
-			if(GetOverlapType(o1.offset, o2.offset) == eCrossing)
-			{
-				o1.touching_offsets.push_back(&o2);
-				o2.touching_offsets.push_back(&o1);
-			}
+	// test them in list order, so the touching_offsets lists are the same as testing every pair
+	std::sort(pairs.begin(), pairs.end());
+	for(unsigned int i = 0; i < pairs.size(); i++)
+	{
+		IslandAndOffset &o1 = *islands[pairs[i].first];
+		IslandAndOffset &o2 = *islands[pairs[i].second];
+
+		if(GetOverlapType(o1.offset, o2.offset) == eCrossing)
+		{
+			o1.touching_offsets.push_back(&o2);
+			o2.touching_offsets.push_back(&o1);
 		}
 	}
 }
 
 void CArea::MakeOnePocketCurve(std::list<CCurve> &curve_list, const CAreaPocketParams &params)const
 {
-	if(CArea::m_please_abort)return;
+	CAreaTraceScope trace("MakeOnePocketCurve");
+	if(CArea::m_progress->m_please_abort)return;
 #if 0  // simple offsets with feed or rapid joins
 	CArea area_for_feed_possible = *this;
 
 	area_for_feed_possible.Offset(-params.tool_radius - 0.01);
-	CArea a_offset = *this;
-
 	std::list<CArea> arealist;
-	recur(arealist, a_offset, params, 0);
+	recur(arealist, CArea(*this), params, 0);
 
 	bool first = true;
 
@@ -498,7 +565,7 @@ void CArea::MakeOnePocketCurve(std::list<CCurve> &curve_list, const CAreaPocketP
 	pocket_params = &params;
 	if(m_curves.size() == 0)
 	{
-		CArea::m_processing_done += CArea::m_single_area_processing_length;
+		CArea::m_progress->AddProcessingDone(CArea::m_progress->m_single_area_processing_length);
 		return;
 	}
 	CurveTree top_level(m_curves.front());
@@ -513,22 +580,24 @@ void CArea::MakeOnePocketCurve(std::list<CCurve> &curve_list, const CAreaPocketP
 			IslandAndOffset island_and_offset(&c);
 			offset_islands.push_back(island_and_offset);
 			top_level.offset_islands.push_back(&(offset_islands.back()));
-			if(m_please_abort)return;
 		}
 	}
 
+	MakeIslandOffsets(offset_islands);
+	if(m_progress->m_please_abort)return;
+
 	MarkOverlappingOffsetIslands(offset_islands);
 
-	CArea::m_processing_done += CArea::m_single_area_processing_length * 0.1;
+	CArea::m_progress->AddProcessingDone(CArea::m_progress->m_single_area_processing_length * 0.1);
 
-	double MakeOffsets_processing_length = CArea::m_single_area_processing_length * 0.8;
-	CArea::m_after_MakeOffsets_length = CArea::m_processing_done + MakeOffsets_processing_length;
+	double MakeOffsets_processing_length = CArea::m_progress->m_single_area_processing_length * 0.8;
+	CArea::m_progress->m_after_MakeOffsets_length = CArea::m_progress->m_processing_done + MakeOffsets_processing_length;
 	double guess_num_offsets = sqrt(GetArea(true)) * 0.5 / params.stepover;
-	CArea::m_MakeOffsets_increment = MakeOffsets_processing_length / guess_num_offsets;
+	CArea::m_progress->m_MakeOffsets_increment = MakeOffsets_processing_length / guess_num_offsets;
 
 	top_level.MakeOffsets();
-	if(CArea::m_please_abort)return;
-	CArea::m_processing_done = CArea::m_after_MakeOffsets_length;
+	if(CArea::m_progress->m_please_abort)return;
+	CArea::m_progress->m_processing_done = CArea::m_progress->m_after_MakeOffsets_length;
 
 	curve_list.push_back(CCurve());
 	CCurve& output = curve_list.back();
@@ -559,7 +628,7 @@ void CArea::MakeOnePocketCurve(std::list<CCurve> &curve_list, const CAreaPocketP
 		delete curve_tree;
 	}
 
-	CArea::m_processing_done += CArea::m_single_area_processing_length * 0.1;
+	CArea::m_progress->AddProcessingDone(CArea::m_progress->m_single_area_processing_length * 0.1);
 #endif
 }
 
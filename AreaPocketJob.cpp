@@ -0,0 +1,90 @@
+// AreaPocketJob.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CAreaPocketJob, CArea::SplitAndMakePocketToolpath running on its own thread
+
+#include "AreaPocketJob.h"
+
+CAreaPocketJob::CAreaPocketJob(const CArea& area, const CAreaPocketParams& params, CAreaPocketListener* listener):m_area(area), m_params(params), m_listener(listener), m_finished(false), m_failed(false)
+{
+	m_settings.m_progress = &m_progress;
+	m_settings.m_stats = &m_stats;
+	m_progress.m_listener = this;
+}
+
+CAreaPocketJob::~CAreaPocketJob()
+{
+	if(m_thread.joinable())
+	{
+		Abort();
+		m_thread.join();
+	}
+}
+
+void CAreaPocketJob::Start()
+{
+	m_thread = std::thread(&CAreaPocketJob::Run, this);
+}
+
+void CAreaPocketJob::Run()
+{
+	m_settings.Apply();
+
+	bool failed = false;
+	try
+	{
+		std::list<CCurve> toolpath; // unused, the curves are collected in OnRegionToolpath
+		m_area.SplitAndMakePocketToolpath(toolpath, m_params);
+	}
+	catch(...)
+	{
+		failed = true;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_failed = failed;
+	m_finished = true;
+	m_finished_condition.notify_all();
+}
+
+void CAreaPocketJob::Abort()
+{
+	m_progress.m_please_abort = true;
+}
+
+bool CAreaPocketJob::Finished()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_finished;
+}
+
+bool CAreaPocketJob::Failed()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_failed;
+}
+
+void CAreaPocketJob::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(!m_finished)m_finished_condition.wait(lock);
+}
+
+void CAreaPocketJob::GetNewCurves(std::list<CCurve> &curves)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	curves.splice(curves.end(), m_new_curves);
+}
+
+void CAreaPocketJob::OnProgress(double processing_done)
+{
+	if(m_listener)m_listener->OnProgress(processing_done);
+}
+
+void CAreaPocketJob::OnRegionToolpath(const std::list<CCurve> &region_toolpath)
+{
+	if(m_listener)m_listener->OnRegionToolpath(region_toolpath);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_new_curves.insert(m_new_curves.end(), region_toolpath.begin(), region_toolpath.end());
+}
@@ -0,0 +1,47 @@
+// AreaPocketJob.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Area.h"
+#include "AreaStats.h"
+
+class CAreaPocketJob : public CAreaPocketListener
+{
+	// makes a pocket toolpath on its own thread
+	// each region's toolpath can be collected with GetNewCurves as soon as it is finished, while later regions are still being done
+
+	CArea m_area;
+	CAreaPocketParams m_params;
+	CAreaSettings m_settings; // the settings of the thread that made the job
+	CAreaPocketListener* m_listener; // the caller's listener, called on the job's thread, can be NULL
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_finished_condition;
+	std::list<CCurve> m_new_curves; // finished, but not collected yet
+	bool m_finished;
+	bool m_failed;
+
+	void Run();
+
+public:
+	CAreaProgress m_progress;
+	CAreaStats m_stats; // of the job's operations, on its own thread and the threads it uses
+
+	CAreaPocketJob(const CArea& area, const CAreaPocketParams& params, CAreaPocketListener* listener = NULL);
+	~CAreaPocketJob(); // aborts the job, if it is still running
+
+	void Start();
+	void Abort();
+	bool Finished();
+	bool Failed(); // true if the job threw an exception
+	void Wait();
+	void GetNewCurves(std::list<CCurve> &curves); // moves the curves finished since the last call to the end of curves
+
+	// CAreaPocketListener's virtual functions
+	void OnProgress(double processing_done);
+	void OnRegionToolpath(const std::list<CCurve> &region_toolpath);
+};
@@ -0,0 +1,107 @@
+// AreaPocketPreview.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CAreaPocketPreview, a quick rough SplitAndMakePocketToolpath with an estimate of the exact toolpath's length
+
+#include "AreaPocketPreview.h"
+#include <algorithm>
+
+static const double PI = 3.1415926535897932;
+
+static double ZigLength(const CCurve& curve, const Point& zig_direction)
+{
+	// the length of the curve's lines which go along the zigs; the rest are zags, along the boundary
+	double length = 0.0;
+	std::list<Span> spans;
+	curve.GetSpans(spans);
+	for(std::list<Span>::const_iterator It = spans.begin(); It != spans.end(); It++)
+	{
+		const Span& span = *It;
+		if(span.m_v.m_type)continue;
+		double span_length = span.Length();
+		if(fabs((span.m_v.m_p - span.m_p) ^ zig_direction) < 0.001 * span_length)length += span_length;
+	}
+	return length;
+}
+
+CAreaPocketPreview::CAreaPocketPreview(const CAreaPocketParams &params):m_params(params), m_stepover_used(0.0), m_length(0.0), m_link_length(0.0), m_accuracy(0.0), m_simplify_tolerance(0.0), m_max_stepovers(50), m_feed_rate(0.0), m_rapid_rate(0.0)
+{
+}
+
+void CAreaPocketPreview::MakePocketToolpath(const CArea &area, std::list<CCurve> &toolpath)
+{
+	m_stepover_used = m_params.stepover;
+	m_length = 0.0;
+	m_link_length = 0.0;
+
+	CAreaBox box;
+	area.GetBox(box);
+	if(!box.m_valid || m_params.stepover <= 0.0)return;
+
+	// no more than m_max_stepovers across the box's longer side
+	double across = std::max(box.Width(), box.Height());
+	if(m_max_stepovers > 0)m_stepover_used = std::max(m_params.stepover, across / m_max_stepovers);
+	CAreaPocketParams params = m_params;
+	params.stepover = m_stepover_used;
+
+	// m_accuracy and m_simplify_tolerance are in the engine's units, the stepover is in the area's
+	double coarse = m_stepover_used * CArea::m_units / 20;
+	double accuracy = (m_accuracy > 0.0) ? m_accuracy : coarse;
+	double simplify_tolerance = (m_simplify_tolerance > 0.0) ? m_simplify_tolerance : coarse;
+
+	CAreaSettings settings;
+	CArea::m_accuracy = std::max(CArea::m_accuracy, accuracy);
+	CArea::m_simplify_tolerance = std::max(CArea::m_simplify_tolerance, simplify_tolerance);
+	double boundary_length = 0.0; // the pass around the edge, which is the same length whatever the stepover
+	try
+	{
+		area.SplitAndMakePocketToolpath(toolpath, params);
+		if(m_params.mode != ZigZagPocketMode && m_params.mode != ZigZagThenSingleOffsetPocketMode && !CArea::m_progress->m_please_abort)
+		{
+			CArea boundary = area;
+			boundary.Offset(m_params.tool_radius + m_params.extra_offset);
+			for(std::list<CCurve>::const_iterator It = boundary.m_curves.begin(); It != boundary.m_curves.end(); It++)boundary_length += It->Perim();
+		}
+	}
+	catch(...)
+	{
+		settings.Apply();
+		throw;
+	}
+	settings.Apply();
+
+	bool zigzag = (m_params.mode == ZigZagPocketMode || m_params.mode == ZigZagThenSingleOffsetPocketMode);
+	Point zig_direction(cos(m_params.zig_angle * PI / 180), sin(m_params.zig_angle * PI / 180));
+	double zig_length = 0.0;
+	const Point* prev_end = NULL;
+	for(std::list<CCurve>::const_iterator It = toolpath.begin(); It != toolpath.end(); It++)
+	{
+		const CCurve& curve = *It;
+		if(curve.m_vertices.size() == 0)continue;
+		m_length += curve.Perim();
+		if(zigzag && !curve.IsClosed())zig_length += ZigLength(curve, zig_direction); // closed curves are the single offset passes
+		if(prev_end)m_link_length += prev_end->dist(curve.m_vertices.front().m_p);
+		prev_end = &(curve.m_vertices.back().m_p);
+	}
+
+	// the exact toolpath has about this many times as many zigs, or passes inside the boundary
+	// the zags between the zigs of one curve go along the boundary, so they add up to about the same length whatever the stepover
+	// the moves between curves are about the same too, as the zigs are joined into one curve until the boundary stops them, not one for each zig
+	double scale = m_stepover_used / m_params.stepover;
+	if(zigzag)
+	{
+		m_length += zig_length * (scale - 1.0);
+	}
+	else
+	{
+		if(boundary_length > m_length)boundary_length = m_length;
+		m_length = boundary_length + (m_length - boundary_length) * scale;
+	}
+}
+
+double CAreaPocketPreview::MachiningTime()const
+{
+	if(m_feed_rate <= 0.0)return 0.0;
+	double rapid_rate = (m_rapid_rate > 0.0) ? m_rapid_rate : m_feed_rate;
+	return m_length / m_feed_rate + m_link_length / rapid_rate;
+}
@@ -0,0 +1,34 @@
+// AreaPocketPreview.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "Area.h"
+
+class CAreaPocketPreview
+{
+	// makes a rough pocket toolpath quickly, for showing and quoting, with an estimate of the exact toolpath's length and time
+	// it is SplitAndMakePocketToolpath at a coarser accuracy, on simplified curves, with the stepover made bigger for big areas
+	// the length inside the boundary pass, or of the zigs, is scaled back up by the ratio of the stepovers, so it is about what the exact toolpath would give
+	// when the user wants the exact toolpath, start a CAreaPocketJob with the same params
+	CAreaPocketParams m_params;
+	double m_stepover_used;
+	double m_length;
+	double m_link_length;
+
+public:
+	// settings, each 0 means worked out from the stepover
+	double m_accuracy; // used instead of CArea::m_accuracy, if it is bigger
+	double m_simplify_tolerance; // used instead of CArea::m_simplify_tolerance, if it is bigger
+	unsigned int m_max_stepovers; // the stepover is made bigger so there are no more than this many across the area
+	double m_feed_rate; // for MachiningTime, in units per minute
+	double m_rapid_rate; // for the moves between curves, 0 means m_feed_rate
+
+	CAreaPocketPreview(const CAreaPocketParams &params);
+
+	void MakePocketToolpath(const CArea &area, std::list<CCurve> &toolpath); // uses CArea::m_progress, like SplitAndMakePocketToolpath
+	double StepoverUsed()const{return m_stepover_used;}
+	double Length()const{return m_length;} // about the length of the exact toolpath's curves
+	double LinkLength()const{return m_link_length;} // the moves from the end of one curve to the start of the next, not scaled, as the zigs are joined into curves by zags, and there are about as many curves
+	double MachiningTime()const; // in minutes, 0 if m_feed_rate is 0
+};
@@ -0,0 +1,415 @@
+// AreaSimplify.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CArea::Simplify, which removes line vertices that are less than a tolerance from the curve without them
+
+#include "Area.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+thread_local double CArea::m_simplify_tolerance = 0.0;
+thread_local unsigned int CArea::m_simplify_vertices_in = 0;
+thread_local unsigned int CArea::m_simplify_vertices_out = 0;
+
+static const double PI = 3.1415926535897932;
+
+static double Cross(const Point& a, const Point& b, const Point& c)
+{
+	// positive if c is to the left of a->b
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+static bool BoxesOverlap(const CAreaBox& b1, const CAreaBox& b2)
+{
+	return b1.MinX() <= b2.MaxX() && b2.MinX() <= b1.MaxX() && b1.MinY() <= b2.MaxY() && b2.MinY() <= b1.MaxY();
+}
+
+static bool InBox(const CAreaBox& box, const Point& p)
+{
+	return p.x >= box.MinX() && p.x <= box.MaxX() && p.y >= box.MinY() && p.y <= box.MaxY();
+}
+
+static double DistToLine(const Point& p, const Point& a, const Point& b)
+{
+	// from p to the line a->b, not to the infinite line
+	Point v(b.x - a.x, b.y - a.y);
+	double len2 = v.x * v.x + v.y * v.y;
+	double t = (len2 > 0.0) ? ((p.x - a.x) * v.x + (p.y - a.y) * v.y) / len2 : 0.0;
+	if(t < 0.0)t = 0.0;
+	if(t > 1.0)t = 1.0;
+	double dx = p.x - (a.x + v.x * t);
+	double dy = p.y - (a.y + v.y * t);
+	return sqrt(dx * dx + dy * dy);
+}
+
+class SimplifySpan
+{
+public:
+	Point m_p0; // start
+	CVertex m_v; // type, end and centre
+	CAreaBox m_box;
+	int m_curve;
+	bool m_dead; // replaced by a shortcut
+
+	SimplifySpan(const Point& p0, const CVertex& v, int curve):m_p0(p0), m_v(v), m_curve(curve), m_dead(false)
+	{
+		Span(p0, v).GetBox(m_box);
+	}
+};
+
+static bool LinesCross(const Point& a, const Point& b, const Point& c, const Point& d)
+{
+	// true if a->b meets c->d anywhere but at an end they both have, or lies back along it from there
+	bool shared_a = (a.x == c.x && a.y == c.y) || (a.x == d.x && a.y == d.y);
+	bool shared_b = (b.x == c.x && b.y == c.y) || (b.x == d.x && b.y == d.y);
+	if(shared_a && shared_b)return true; // the same line
+	if(shared_a || shared_b)
+	{
+		const Point& p = shared_a ? a : b;
+		const Point& q = shared_a ? b : a;
+		const Point& r = (p.x == c.x && p.y == c.y) ? d : c;
+		if(Cross(p, q, r) != 0.0)return false;
+		return ((q.x - p.x) * (r.x - p.x) + (q.y - p.y) * (r.y - p.y)) > 0.0;
+	}
+
+	double o1 = Cross(a, b, c);
+	double o2 = Cross(a, b, d);
+	if((o1 > 0.0 && o2 > 0.0) || (o1 < 0.0 && o2 < 0.0))return false;
+	double o3 = Cross(c, d, a);
+	double o4 = Cross(c, d, b);
+	if((o3 > 0.0 && o4 > 0.0) || (o3 < 0.0 && o4 < 0.0))return false;
+	if(o1 == 0.0 && o2 == 0.0)
+	{
+		// along the same line, see if they overlap
+		return std::max(std::min(a.x, b.x), std::min(c.x, d.x)) <= std::min(std::max(a.x, b.x), std::max(c.x, d.x))
+			&& std::max(std::min(a.y, b.y), std::min(c.y, d.y)) <= std::min(std::max(a.y, b.y), std::max(c.y, d.y));
+	}
+	return true;
+}
+
+static bool OnArc(const Point& p, const Point& p0, const CVertex& v)
+{
+	// p is on the arc's circle, is it between the arc's ends
+	double a0 = atan2(p0.y - v.m_c.y, p0.x - v.m_c.x);
+	double a1 = atan2(v.m_p.y - v.m_c.y, v.m_p.x - v.m_c.x);
+	double a = atan2(p.y - v.m_c.y, p.x - v.m_c.x);
+	if(v.m_type == -1){std::swap(a0, a1);}
+	double sweep = a1 - a0;
+	while(sweep <= 0.0)sweep += 2 * PI;
+	double da = a - a0;
+	while(da < 0.0)da += 2 * PI;
+	while(da >= 2 * PI)da -= 2 * PI;
+	return da <= sweep + 1.0e-9;
+}
+
+static bool LineCrossesArc(const Point& a, const Point& b, const Point& p0, const CVertex& v)
+{
+	// true if a->b meets the arc, other than at an end they both have
+	double r = p0.dist(v.m_c);
+	Point d(b.x - a.x, b.y - a.y);
+	Point f(a.x - v.m_c.x, a.y - v.m_c.y);
+	double qa = d.x * d.x + d.y * d.y;
+	if(qa == 0.0)return false;
+	double qb = 2 * (f.x * d.x + f.y * d.y);
+	double qc = f.x * f.x + f.y * f.y - r * r;
+	double disc = qb * qb - 4 * qa * qc;
+	if(disc < 0.0)return false;
+	disc = sqrt(disc);
+	double len = sqrt(qa);
+	double eps = 1.0e-9 * (len + r);
+	for(int i = 0; i < 2; i++)
+	{
+		double t = (i == 0) ? ((-qb - disc) / (2 * qa)) : ((-qb + disc) / (2 * qa));
+		if(t * len < -eps || (t - 1.0) * len > eps)continue;
+		Point p(a.x + d.x * t, a.y + d.y * t);
+		bool shared = false;
+		if(p.dist(a) <= eps && (a.dist(p0) <= eps || a.dist(v.m_p) <= eps))shared = true;
+		if(p.dist(b) <= eps && (b.dist(p0) <= eps || b.dist(v.m_p) <= eps))shared = true;
+		if(!shared && OnArc(p, p0, v))return true;
+	}
+	return false;
+}
+
+class CSimplifier
+{
+	// Douglas-Peucker on the runs of lines between arcs, the arcs are kept as they are
+	// a shortcut is only taken if it doesn't cross any span still there, and doesn't go round the other side of any curve
+	// so curves never cross each other, or themselves, because of it
+	std::vector<CCurve*> m_curves;
+	std::vector<SimplifySpan> m_spans;
+	std::vector<int> m_first_span; // for each curve
+	std::vector<std::vector<int> > m_cells; // spans in each cell of a grid
+	std::vector<std::vector<int> > m_point_cells; // curves with their first point in each cell
+	std::vector<unsigned int> m_stamp; // for each span, so each is only tested once per shortcut
+	unsigned int m_current_stamp;
+	CAreaBox m_box;
+	double m_cell_size;
+	int m_nx, m_ny;
+	double m_tolerance;
+
+	void CellRange(const CAreaBox& box, int &x0, int &y0, int &x1, int &y1)const
+	{
+		x0 = std::max(0, std::min(m_nx - 1, (int)((box.MinX() - m_box.MinX()) / m_cell_size)));
+		y0 = std::max(0, std::min(m_ny - 1, (int)((box.MinY() - m_box.MinY()) / m_cell_size)));
+		x1 = std::max(0, std::min(m_nx - 1, (int)((box.MaxX() - m_box.MinX()) / m_cell_size)));
+		y1 = std::max(0, std::min(m_ny - 1, (int)((box.MaxY() - m_box.MinY()) / m_cell_size)));
+	}
+
+	void AddSpan(const SimplifySpan& span)
+	{
+		int index = (int)m_spans.size();
+		m_spans.push_back(span);
+		m_stamp.push_back(0);
+		int x0, y0, x1, y1;
+		CellRange(span.m_box, x0, y0, x1, y1);
+		for(int y = y0; y <= y1; y++)
+			for(int x = x0; x <= x1; x++)m_cells[y * m_nx + x].push_back(index);
+	}
+
+	bool Crosses(const Point& a, const Point& b, int curve, int first_span, int last_span)
+	{
+		// does a->b cross any live span, other than the ones it replaces, first_span to last_span of curve
+		CAreaBox box;
+		box.Insert(a);
+		box.Insert(b);
+		m_current_stamp++;
+		int x0, y0, x1, y1;
+		CellRange(box, x0, y0, x1, y1);
+		for(int y = y0; y <= y1; y++)
+		{
+			for(int x = x0; x <= x1; x++)
+			{
+				const std::vector<int>& cell = m_cells[y * m_nx + x];
+				for(std::vector<int>::const_iterator It = cell.begin(); It != cell.end(); It++)
+				{
+					int i = *It;
+					if(m_stamp[i] == m_current_stamp)continue;
+					m_stamp[i] = m_current_stamp;
+					const SimplifySpan& span = m_spans[i];
+					if(span.m_dead)continue;
+					if(span.m_curve == curve && i >= first_span && i <= last_span)continue;
+					if(!BoxesOverlap(box, span.m_box))continue;
+					if(span.m_v.m_type == 0)
+					{
+						if(LinesCross(a, b, span.m_p0, span.m_v.m_p))return true;
+					}
+					else
+					{
+						if(LineCrossesArc(a, b, span.m_p0, span.m_v))return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	static bool Inside(const Point& p, const std::vector<CVertex>& v, int i, int j)
+	{
+		// is p inside the polygon v[i] to v[j] and back to v[i], even-odd
+		bool inside = false;
+		for(int k = i; k <= j; k++)
+		{
+			const Point& p0 = v[k].m_p;
+			const Point& p1 = (k == j) ? v[i].m_p : v[k + 1].m_p;
+			if((p0.y > p.y) != (p1.y > p.y))
+			{
+				double x = p0.x + (p.y - p0.y) * (p1.x - p0.x) / (p1.y - p0.y);
+				if(p.x < x)inside = !inside;
+			}
+		}
+		return inside;
+	}
+
+	bool GoesRoundACurve(int curve, const std::vector<CVertex>& v, int i, int j, const CAreaBox& box)
+	{
+		// would the shortcut v[i] to v[j] put any curve on the other side of this one
+		// with no spans crossing, a curve is all in or all out of what the shortcut cuts off, so one point each is tested
+		int x0, y0, x1, y1;
+		CellRange(box, x0, y0, x1, y1);
+		for(int y = y0; y <= y1; y++)
+		{
+			for(int x = x0; x <= x1; x++)
+			{
+				const std::vector<int>& cell = m_point_cells[y * m_nx + x];
+				for(std::vector<int>::const_iterator It = cell.begin(); It != cell.end(); It++)
+				{
+					if(*It == curve)continue;
+					const Point& p = m_curves[*It]->m_vertices.front().m_p;
+					if(InBox(box, p) && Inside(p, v, i, j))return true;
+				}
+			}
+		}
+
+		// and the rest of this curve, which could set off into the cut off bit from v[j]
+		int n = (int)v.size();
+		int k = j + 1;
+		if(k >= n && v.front().m_p == v.back().m_p)k = 1;
+		if(k < n && (k < i || k > j) && InBox(box, v[k].m_p) && Inside(v[k].m_p, v, i, j))return true;
+		return false;
+	}
+
+	void SimplifyRun(int curve, std::vector<CVertex>& v, std::vector<bool>& keep, int first, int last)
+	{
+		// v[first] to v[last] are joined by lines, and they are kept
+		std::vector<std::pair<int, int> > stack;
+		stack.push_back(std::make_pair(first, last));
+		while(!stack.empty())
+		{
+			int i = stack.back().first;
+			int j = stack.back().second;
+			stack.pop_back();
+			if(j - i < 2)continue;
+
+			int farthest = -1;
+			double max_d = -1.0;
+			CAreaBox box;
+			box.Insert(v[i].m_p);
+			for(int k = i + 1; k < j; k++)
+			{
+				double d = DistToLine(v[k].m_p, v[i].m_p, v[j].m_p);
+				if(d > max_d){max_d = d; farthest = k;}
+				box.Insert(v[k].m_p);
+			}
+			box.Insert(v[j].m_p);
+
+			// the spans from v[i] to v[j] are m_spans[base + i] to m_spans[base + j - 1]
+			int base = m_first_span[curve] - 1;
+			if(max_d <= m_tolerance && !(v[i].m_p == v[j].m_p) && !Crosses(v[i].m_p, v[j].m_p, curve, base + i + 1, base + j) && !GoesRoundACurve(curve, v, i, j, box))
+			{
+				for(int k = i + 1; k < j; k++)keep[k] = false;
+				for(int k = i + 1; k <= j; k++)m_spans[base + k].m_dead = true;
+				AddSpan(SimplifySpan(v[i].m_p, CVertex(v[j].m_p), curve));
+				continue;
+			}
+
+			stack.push_back(std::make_pair(farthest, j));
+			stack.push_back(std::make_pair(i, farthest));
+		}
+	}
+
+public:
+	CSimplifier(CArea& area, double tolerance):m_current_stamp(0), m_cell_size(1.0), m_nx(1), m_ny(1), m_tolerance(tolerance)
+	{
+		area.GetBox(m_box);
+		unsigned int num_spans = 0;
+		for(std::list<CCurve>::iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)
+		{
+			m_curves.push_back(&(*It));
+			if(It->m_vertices.size() > 1)num_spans += (unsigned int)It->m_vertices.size() - 1;
+		}
+		if(!m_box.m_valid || num_spans == 0)return;
+
+		// about two spans per cell
+		double w = std::max(m_box.Width(), m_box.Height() * 1.0e-3);
+		double h = std::max(m_box.Height(), m_box.Width() * 1.0e-3);
+		if(w <= 0.0)w = h = 1.0;
+		m_cell_size = sqrt(w * h * 2.0 / num_spans);
+		m_nx = std::min(1024, (int)(w / m_cell_size) + 1);
+		m_ny = std::min(1024, (int)(h / m_cell_size) + 1);
+		m_cell_size = std::max(w / m_nx, h / m_ny) * 1.000001;
+		m_cells.resize(m_nx * m_ny);
+		m_point_cells.resize(m_nx * m_ny);
+
+		m_spans.reserve(num_spans * 2);
+		m_stamp.reserve(num_spans * 2);
+		for(int c = 0; c < (int)m_curves.size(); c++)
+		{
+			const CCurve& curve = *m_curves[c];
+			m_first_span.push_back((int)m_spans.size());
+			if(curve.m_vertices.size() == 0)continue;
+			const Point* prev_p = NULL;
+			for(std::list<CVertex>::const_iterator VIt = curve.m_vertices.begin(); VIt != curve.m_vertices.end(); VIt++)
+			{
+				if(prev_p)AddSpan(SimplifySpan(*prev_p, *VIt, c));
+				prev_p = &(VIt->m_p);
+			}
+			CAreaBox point_box;
+			point_box.Insert(curve.m_vertices.front().m_p);
+			int x0, y0, x1, y1;
+			CellRange(point_box, x0, y0, x1, y1);
+			m_point_cells[y0 * m_nx + x0].push_back(c);
+		}
+	}
+
+	unsigned int Do()
+	{
+		unsigned int removed = 0;
+		for(int c = 0; c < (int)m_curves.size(); c++)
+		{
+			CCurve& curve = *m_curves[c];
+			if(curve.m_vertices.size() < 3)continue;
+
+			std::vector<CVertex> v(curve.m_vertices.begin(), curve.m_vertices.end());
+			int n = (int)v.size();
+			std::vector<bool> keep(n, true);
+			int first_shortcut = (int)m_spans.size();
+
+			bool all_lines = true;
+			for(int k = 1; k < n; k++){if(v[k].m_type != 0){all_lines = false; break;}}
+			bool closed = (v.front().m_p == v.back().m_p);
+
+			if(all_lines && closed)
+			{
+				// the point farthest from the start is kept too, so neither half is a shortcut back to the start
+				int farthest = 0;
+				double max_d = -1.0;
+				for(int k = 1; k < n - 1; k++)
+				{
+					double d = v[k].m_p.dist(v[0].m_p);
+					if(d > max_d){max_d = d; farthest = k;}
+				}
+				SimplifyRun(c, v, keep, 0, farthest);
+				SimplifyRun(c, v, keep, farthest, n - 1);
+			}
+			else
+			{
+				// each run of lines, between arcs or the ends
+				int first = 0;
+				for(int k = 1; k < n; k++)
+				{
+					if(v[k].m_type != 0)
+					{
+						SimplifyRun(c, v, keep, first, k - 1);
+						first = k;
+					}
+				}
+				SimplifyRun(c, v, keep, first, n - 1);
+			}
+
+			int num_kept = 0;
+			for(int k = 0; k < n; k++){if(keep[k])num_kept++;}
+			if(num_kept == n)continue;
+			if(closed && num_kept < 4)
+			{
+				// it would have no area left, leave it as it was, with its own spans back for the others
+				for(int k = 1; k < n; k++)m_spans[m_first_span[c] + k - 1].m_dead = false;
+				for(int k = first_shortcut; k < (int)m_spans.size(); k++)m_spans[k].m_dead = true;
+				continue;
+			}
+
+			curve.m_vertices.clear();
+			for(int k = 0; k < n; k++){if(keep[k])curve.m_vertices.push_back(v[k]);}
+			curve.VerticesChanged();
+			removed += n - num_kept;
+		}
+		return removed;
+	}
+};
+
+unsigned int CArea::Simplify(double tolerance)
+{
+	unsigned int vertices_in = 0;
+	for(std::list<CCurve>::const_iterator It = m_curves.begin(); It != m_curves.end(); It++)vertices_in += (unsigned int)It->m_vertices.size();
+	m_simplify_vertices_in += vertices_in;
+
+	unsigned int removed = 0;
+	if(tolerance > 0.0)
+	{
+		CSimplifier simplifier(*this, tolerance);
+		removed = simplifier.Do();
+	}
+
+	m_simplify_vertices_out += vertices_in - removed;
+	return removed;
+}
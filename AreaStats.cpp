@@ -0,0 +1,115 @@
+// AreaStats.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CAreaStats, counts and times of Offset, booleans, Reorder and FitArcs
+
+#include "AreaStats.h"
+#include "Area.h"
+#include <chrono>
+
+static thread_local CAreaStats default_stats_for_thread;
+thread_local CAreaStats* CArea::m_stats = &default_stats_for_thread;
+static thread_local int depth[CAreaStats::NumOperations] = {0}; // of CAreaStatsScopes of each kind, on this thread
+
+CAreaStats::Counts CAreaStats::Get(int operation)const
+{
+	Counts counts;
+	counts.m_calls = m_calls[operation];
+	counts.m_vertices_in = m_vertices_in[operation];
+	counts.m_vertices_out = m_vertices_out[operation];
+	counts.m_seconds = m_nanoseconds[operation] * 1.0e-9;
+	counts.m_peak_bytes = m_peak_bytes[operation];
+	return counts;
+}
+
+void CAreaStats::Reset()
+{
+	for(int i = 0; i < NumOperations; i++)
+	{
+		m_calls[i] = 0;
+		m_vertices_in[i] = 0;
+		m_vertices_out[i] = 0;
+		m_nanoseconds[i] = 0;
+		m_peak_bytes[i] = 0;
+	}
+}
+
+void CAreaStats::Add(int operation, unsigned long long vertices_in, unsigned long long vertices_out, unsigned long long nanoseconds, unsigned long long peak_bytes)
+{
+	m_calls[operation]++;
+	m_vertices_in[operation] += vertices_in;
+	m_vertices_out[operation] += vertices_out;
+	m_nanoseconds[operation] += nanoseconds;
+	unsigned long long peak = m_peak_bytes[operation];
+	while(peak_bytes > peak && !m_peak_bytes[operation].compare_exchange_weak(peak, peak_bytes)){}
+}
+
+const char* CAreaStats::OperationName(int operation)
+{
+	switch(operation)
+	{
+	case BooleanOperation:
+		return "boolean";
+	case OffsetOperation:
+		return "offset";
+	case ReorderOperation:
+		return "reorder";
+	case FitArcsOperation:
+		return "fitarcs";
+	}
+	return "";
+}
+
+static unsigned long long NumVertices(const CArea& area)
+{
+	unsigned long long n = 0;
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)n += It->m_vertices.size();
+	return n;
+}
+
+static long long Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CAreaStatsScope::CAreaStatsScope(int operation, const CArea& area, const CArea* a2):m_operation(operation), m_in_depth(false), m_area(NULL), m_curve(NULL), m_vertices_in(0)
+{
+	if(CArea::m_stats == NULL)return;
+	m_in_depth = true;
+	if(depth[operation]++ > 0)return;
+	m_area = &area;
+	m_vertices_in = NumVertices(area);
+	if(a2)m_vertices_in += NumVertices(*a2);
+	Start();
+}
+
+CAreaStatsScope::CAreaStatsScope(int operation, const CCurve& curve):m_operation(operation), m_in_depth(false), m_area(NULL), m_curve(NULL), m_vertices_in(0)
+{
+	if(CArea::m_stats == NULL)return;
+	m_in_depth = true;
+	if(depth[operation]++ > 0)return;
+	m_curve = &curve;
+	m_vertices_in = curve.m_vertices.size();
+	Start();
+}
+
+void CAreaStatsScope::Start()
+{
+	// the peak is measured from what was in use at the start, and put back after, for any scope this one is inside
+	m_start_bytes = CAreaStats::EngineBytesInUse();
+	m_save_peak_bytes = CAreaStats::EnginePeakBytes();
+	CAreaStats::SetEnginePeakBytes(m_start_bytes);
+	m_start = Now();
+}
+
+CAreaStatsScope::~CAreaStatsScope()
+{
+	if(m_in_depth)depth[m_operation]--;
+	if(m_area == NULL && m_curve == NULL)return;
+
+	long long nanoseconds = Now() - m_start;
+	size_t peak = CAreaStats::EnginePeakBytes();
+	if(peak < m_save_peak_bytes)CAreaStats::SetEnginePeakBytes(m_save_peak_bytes);
+	unsigned long long vertices_out = m_area ? NumVertices(*m_area) : m_curve->m_vertices.size();
+	if(CArea::m_stats)CArea::m_stats->Add(m_operation, m_vertices_in, vertices_out, nanoseconds, peak - m_start_bytes);
+}
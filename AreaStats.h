@@ -0,0 +1,79 @@
+// AreaStats.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+class CArea;
+class CCurve;
+
+class CAreaStats
+{
+	// call counts, vertices, times and memory of the operations done by the threads using it, see CArea::m_stats
+	// the counts can be added to from many threads at once, as the island offsets in a pocket are
+public:
+	enum
+	{
+		BooleanOperation, // Subtract, Intersect and Union
+		OffsetOperation,
+		ReorderOperation,
+		FitArcsOperation, // each curve fitted, as the engines fit each curve of their results
+		NumOperations,
+	};
+
+	class Counts
+	{
+	public:
+		unsigned long long m_calls;
+		unsigned long long m_vertices_in;
+		unsigned long long m_vertices_out;
+		double m_seconds;
+		unsigned long long m_peak_bytes; // the most memory the polygon engine had in use for one call
+
+		Counts():m_calls(0), m_vertices_in(0), m_vertices_out(0), m_seconds(0.0), m_peak_bytes(0){}
+	};
+
+	CAreaStats(){Reset();}
+
+	Counts Get(int operation)const;
+	void Reset();
+	void Add(int operation, unsigned long long vertices_in, unsigned long long vertices_out, unsigned long long nanoseconds, unsigned long long peak_bytes);
+	static const char* OperationName(int operation);
+
+	// the polygon engine's memory on the calling thread, implemented by each engine, like CArea::HolesLinked
+	// kbool's is that of its pool; clipper doesn't count its memory, so these are 0 with clipper
+	static size_t EngineBytesInUse();
+	static size_t EnginePeakBytes();
+	static void SetEnginePeakBytes(size_t bytes);
+
+private:
+	std::atomic<unsigned long long> m_calls[NumOperations];
+	std::atomic<unsigned long long> m_vertices_in[NumOperations];
+	std::atomic<unsigned long long> m_vertices_out[NumOperations];
+	std::atomic<unsigned long long> m_nanoseconds[NumOperations];
+	std::atomic<unsigned long long> m_peak_bytes[NumOperations];
+};
+
+class CAreaStatsScope
+{
+	// counts one operation in the calling thread's CArea::m_stats, from when it is made to when it goes out of scope
+	// the area or curve is counted going in, then again coming out, as the operations change it in place
+	// an operation inside another of the same kind isn't counted again, so strips and nested booleans count once
+	int m_operation;
+	bool m_in_depth; // added to the depth of its kind
+	const CArea* m_area; // NULL, with m_curve, if it isn't counted
+	const CCurve* m_curve;
+	unsigned long long m_vertices_in;
+	long long m_start; // nanoseconds
+	size_t m_start_bytes;
+	size_t m_save_peak_bytes;
+
+	void Start();
+
+public:
+	CAreaStatsScope(int operation, const CArea& area, const CArea* a2 = NULL);
+	CAreaStatsScope(int operation, const CCurve& curve);
+	~CAreaStatsScope();
+};
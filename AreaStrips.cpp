@@ -0,0 +1,612 @@
+// AreaStrips.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CAreaStrips, Offset and booleans on big areas done a vertical strip at a time
+
+#include "AreaStrips.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+thread_local unsigned int CArea::m_strips = 0;
+thread_local unsigned int CArea::m_strip_min_vertices = 20000;
+
+static unsigned int NumVertices(const CArea& area)
+{
+	unsigned int n = 0;
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)n += (unsigned int)It->m_vertices.size();
+	return n;
+}
+
+static void AddXs(const CArea& area, std::vector<double> &xs)
+{
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)
+	{
+		for(std::list<CVertex>::const_iterator VIt = It->m_vertices.begin(); VIt != It->m_vertices.end(); VIt++)xs.push_back(VIt->m_p.x);
+	}
+}
+
+static CArea MakeRectangle(double x0, double y0, double x1, double y1)
+{
+	// anti-clockwise, like an outside
+	CCurve curve;
+	curve.append(CVertex(Point(x0, y0)));
+	curve.append(CVertex(Point(x1, y0)));
+	curve.append(CVertex(Point(x1, y1)));
+	curve.append(CVertex(Point(x0, y1)));
+	curve.append(CVertex(Point(x0, y0)));
+	CArea area;
+	area.append(std::move(curve));
+	return area;
+}
+
+static void CutToRectangle(CArea& area, const CArea& rectangle)
+{
+	// the engines don't all give the curves back going the same way round as they were given, so turn them back if needed
+	bool clockwise = area.GetArea() > 0.0;
+	area.Intersect(rectangle);
+	if(area.m_curves.size() > 0 && (area.GetArea() > 0.0) != clockwise)
+	{
+		for(std::list<CCurve>::iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)It->Reverse();
+	}
+}
+
+static void CutCurvesToRectangle(CArea& area, const CArea& rectangle)
+{
+	// cuts each curve on its own, for Offset, the engine's Offset goes wrong with the curves it gets back from cutting them all together
+	CAreaBox rectangle_box;
+	rectangle.GetBox(rectangle_box);
+	std::list<CCurve> curves;
+	curves.swap(area.m_curves);
+	for(std::list<CCurve>::iterator It = curves.begin(); It != curves.end(); It++)
+	{
+		CAreaBox box;
+		It->GetBox(box);
+		CArea curve_area;
+		curve_area.append(*It);
+		if(box.MinX() < rectangle_box.MinX() || box.MaxX() > rectangle_box.MaxX())CutToRectangle(curve_area, rectangle);
+		area.m_curves.splice(area.m_curves.end(), curve_area.m_curves);
+	}
+}
+
+static bool GetCurvesInStrip(const CArea& area, double x0, double x1, CArea& strip_area)
+{
+	// adds the curves whose boxes reach between x0 and x1, returns true if any of them go outside x0 to x1
+	// a hole is never wider than its outside, so leaving out the other curves still leaves a proper area
+	bool crosses = false;
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)
+	{
+		CAreaBox box;
+		It->GetBox(box);
+		if(!box.m_valid || box.MaxX() < x0 || box.MinX() > x1)continue;
+		if(box.MinX() < x0 || box.MaxX() > x1)crosses = true;
+		strip_area.append(*It);
+	}
+	return crosses;
+}
+
+static bool InsideLines(const Point& p, const CCurve& curve)
+{
+	// is p inside the curve, even-odd, the strips' results are all lines
+	bool inside = false;
+	const Point* prev_p = NULL;
+	for(std::list<CVertex>::const_iterator It = curve.m_vertices.begin(); It != curve.m_vertices.end(); It++)
+	{
+		const Point& p1 = It->m_p;
+		if(prev_p && ((prev_p->y > p.y) != (p1.y > p.y)))
+		{
+			double x = prev_p->x + (p.y - prev_p->y) * (p1.x - prev_p->x) / (p1.y - prev_p->y);
+			if(p.x < x)inside = !inside;
+		}
+		prev_p = &p1;
+	}
+	return inside;
+}
+
+static void DoStrip(int operation, const CArea& area, const CArea* a2, double value, double x0, double x1, double y0, double y1, CArea &result)
+{
+	// result gets the operation's result between x0 and x1
+	// for Offset the inputs are cut further out, so their cut edges don't get offset into the strip
+	double margin = (operation == CAreaStrips::OffsetOperation) ? (2.0 * fabs(value) + 10.0 * CArea::m_accuracy) : 0.0;
+	CArea rectangle = MakeRectangle(x0 - margin, y0, x1 + margin, y1);
+
+	if(GetCurvesInStrip(area, x0 - margin, x1 + margin, result))
+	{
+		if(operation == CAreaStrips::OffsetOperation)CutCurvesToRectangle(result, rectangle);
+		else CutToRectangle(result, rectangle);
+	}
+
+	CArea strip_a2;
+	if(a2 && GetCurvesInStrip(*a2, x0 - margin, x1 + margin, strip_a2) && operation == CAreaStrips::UnionOperation)CutToRectangle(strip_a2, rectangle);
+
+	// the engines aren't given empty areas
+	switch(operation)
+	{
+	case CAreaStrips::SubtractOperation:
+		if(result.m_curves.size() > 0 && strip_a2.m_curves.size() > 0)result.Subtract(strip_a2);
+		break;
+	case CAreaStrips::IntersectOperation:
+		if(strip_a2.m_curves.size() == 0)result.m_curves.clear();
+		else if(result.m_curves.size() > 0)result.Intersect(strip_a2);
+		break;
+	case CAreaStrips::UnionOperation:
+		if(result.m_curves.size() == 0)result.m_curves.swap(strip_a2.m_curves);
+		else if(strip_a2.m_curves.size() > 0)result.Union(strip_a2);
+		break;
+	case CAreaStrips::OffsetOperation:
+		if(result.m_curves.size() > 0)
+		{
+			result.Offset(value);
+			CAreaBox box;
+			result.GetBox(box);
+			if(box.m_valid && (box.MinX() < x0 || box.MaxX() > x1))CutToRectangle(result, MakeRectangle(x0, y0, x1, y1));
+		}
+		break;
+	}
+}
+
+class StripSeamEdge
+{
+public:
+	Point m_p0, m_p1; // going from m_p0 to m_p1
+	int m_group;
+	int m_user_data;
+};
+
+class StripJoinEdge
+{
+public:
+	Point m_p0;
+	CVertex m_v; // the end of the edge
+	StripJoinEdge(const Point& p0, const CVertex& v):m_p0(p0), m_v(v){}
+};
+
+class CStripJoiner
+{
+	// joins the strips' results where they meet along the seams between them
+	// the edges on a seam cancel out where both strips have them, the rest of the edges of the curves touching the seams are then chained into new curves
+	// holes and outsides which don't touch a seam are kept as they are
+	std::vector<CArea> &m_results;
+	const std::vector<double> &m_seams; // m_seams[i] is between strip i and strip i + 1
+	double m_tolerance;
+
+	std::vector<CCurve*> m_curves;
+	std::vector<int> m_curve_group;
+	std::vector<bool> m_curve_on_seam;
+	std::vector<int> m_group_strip;
+	std::vector<int> m_group_parent; // groups joined along a seam have the same root
+	std::vector<bool> m_group_on_seam;
+	std::vector<bool> m_group_clockwise; // which way its outside goes round
+	std::vector< std::vector<StripSeamEdge> > m_seam_edges[2]; // for each seam, from the strip on its left and on its right
+	std::vector< std::pair<int, StripJoinEdge> > m_remaining_seam_edges; // with their groups
+
+	int Root(int group)
+	{
+		while(m_group_parent[group] != group)
+		{
+			m_group_parent[group] = m_group_parent[m_group_parent[group]];
+			group = m_group_parent[group];
+		}
+		return group;
+	}
+
+	int SeamOf(const Point& p0, const Point& p1, int strip)const
+	{
+		// the seam, on either side of the strip, which the edge from p0 to p1 lies along, or -1
+		// the engines round the points to their grid, so the cut edges are upright, but can be a grid step or two either side of the seam
+		if(p0.y == p1.y || p0.x != p1.x)return -1;
+		for(int seam = strip - 1; seam <= strip; seam++)
+		{
+			if(seam < 0 || seam >= (int)m_seams.size())continue;
+			if(fabs(p0.x - m_seams[seam]) <= m_tolerance)return seam;
+		}
+		return -1;
+	}
+
+	bool JoinSeam(int seam);
+	bool ChainEdges(std::vector<StripJoinEdge> &edges, std::list<CCurve> &curves)const;
+
+public:
+	CStripJoiner(std::vector<CArea> &results, const std::vector<double> &seams):m_results(results), m_seams(seams), m_tolerance(CArea::m_accuracy){}
+
+	bool Join(CArea &area);
+};
+
+bool CStripJoiner::JoinSeam(int seam)
+{
+	// cancels out the parts of the seam covered from both sides, joining their groups, and keeps the rest of the seam edges
+	std::vector< std::pair<double, Point> > ys;
+	for(int side = 0; side < 2; side++)
+	{
+		for(std::vector<StripSeamEdge>::iterator It = m_seam_edges[side][seam].begin(); It != m_seam_edges[side][seam].end(); It++)
+		{
+			ys.push_back(std::make_pair(It->m_p0.y, It->m_p0));
+			ys.push_back(std::make_pair(It->m_p1.y, It->m_p1));
+		}
+	}
+	if(ys.size() == 0)return true;
+
+	// the kept seam edges go between the seam edges' own points, so they meet the other edges exactly
+	std::sort(ys.begin(), ys.end(), [](const std::pair<double, Point> &a, const std::pair<double, Point> &b){return a.first < b.first;});
+	std::vector< std::pair<double, Point> > points;
+	for(std::vector< std::pair<double, Point> >::iterator It = ys.begin(); It != ys.end(); It++)
+	{
+		if(points.size() == 0 || points.back().first != It->first)points.push_back(*It);
+	}
+
+	// which group covers each interval between neighbouring ys, from each side, and which way
+	int num_intervals = (int)points.size() - 1;
+	std::vector<int> cover[2];
+	std::vector<bool> up[2];
+	std::vector<int> user_data[2];
+	for(int side = 0; side < 2; side++)
+	{
+		cover[side].resize(num_intervals, -1);
+		up[side].resize(num_intervals, false);
+		user_data[side].resize(num_intervals, 0);
+		for(std::vector<StripSeamEdge>::iterator It = m_seam_edges[side][seam].begin(); It != m_seam_edges[side][seam].end(); It++)
+		{
+			double ylo = std::min(It->m_p0.y, It->m_p1.y);
+			double yhi = std::max(It->m_p0.y, It->m_p1.y);
+			int i0 = (int)(std::lower_bound(points.begin(), points.end(), ylo, [](const std::pair<double, Point> &a, double y){return a.first < y;}) - points.begin());
+			for(int i = i0; i < num_intervals && points[i].first < yhi; i++)
+			{
+				if(cover[side][i] != -1)return false; // one strip's curves overlapping each other on the seam
+				cover[side][i] = It->m_group;
+				up[side][i] = It->m_p1.y > It->m_p0.y;
+				user_data[side][i] = It->m_user_data;
+			}
+		}
+	}
+
+	// keep runs of intervals covered from only one side
+	int run_start = -1;
+	for(int i = 0; i <= num_intervals; i++)
+	{
+		int side = -1;
+		if(i < num_intervals)
+		{
+			if(cover[0][i] != -1 && cover[1][i] != -1)
+			{
+				int r0 = Root(cover[0][i]);
+				int r1 = Root(cover[1][i]);
+				if(r0 != r1)m_group_parent[r0] = r1;
+			}
+			else if(cover[0][i] != -1)side = 0;
+			else if(cover[1][i] != -1)side = 1;
+		}
+
+		if(run_start != -1)
+		{
+			int run_side = (cover[0][run_start] != -1) ? 0 : 1;
+			if(side == run_side && cover[side][i] == cover[run_side][run_start] && up[side][i] == up[run_side][run_start])continue;
+
+			const Point &p0 = points[run_start].second;
+			const Point &p1 = points[i].second;
+			int group = cover[run_side][run_start];
+			if(up[run_side][run_start])m_remaining_seam_edges.push_back(std::make_pair(group, StripJoinEdge(p0, CVertex(p1, user_data[run_side][run_start]))));
+			else m_remaining_seam_edges.push_back(std::make_pair(group, StripJoinEdge(p1, CVertex(p0, user_data[run_side][run_start]))));
+			run_start = -1;
+		}
+
+		if(side != -1)run_start = i;
+	}
+
+	return true;
+}
+
+bool CStripJoiner::ChainEdges(std::vector<StripJoinEdge> &edges, std::list<CCurve> &curves)const
+{
+	// makes closed curves from the edges, returns false if they don't all join up
+	std::multimap<std::pair<double, double>, unsigned int> edges_starting_at;
+	for(unsigned int i = 0; i < edges.size(); i++)edges_starting_at.insert(std::make_pair(std::make_pair(edges[i].m_p0.x, edges[i].m_p0.y), i));
+
+	std::vector<bool> used(edges.size(), false);
+	for(unsigned int first = 0; first < edges.size(); first++)
+	{
+		if(used[first])continue;
+		CCurve curve;
+		curve.append(CVertex(edges[first].m_p0));
+		unsigned int i = first;
+		while(true)
+		{
+			used[i] = true;
+			curve.m_vertices.push_back(edges[i].m_v);
+			const Point &p = edges[i].m_v.m_p;
+			if(p.x == edges[first].m_p0.x && p.y == edges[first].m_p0.y)break;
+
+			std::multimap<std::pair<double, double>, unsigned int>::iterator It = edges_starting_at.find(std::make_pair(p.x, p.y));
+			while(It != edges_starting_at.end() && It->first.first == p.x && It->first.second == p.y && used[It->second])It++;
+			if(It == edges_starting_at.end() || It->first.first != p.x || It->first.second != p.y)return false;
+			i = It->second;
+		}
+		curve.VerticesChanged();
+		curves.push_back(std::move(curve));
+	}
+	return true;
+}
+
+bool CStripJoiner::Join(CArea &area)
+{
+	// split each strip's result into groups, an outside with its holes
+	for(unsigned int strip = 0; strip < m_results.size(); strip++)
+	{
+		bool first_curve = true;
+		bool outer_clockwise = false;
+		unsigned int strip_first_curve = (unsigned int)m_curves.size();
+		std::vector<int> outers; // curves
+		for(std::list<CCurve>::iterator It = m_results[strip].m_curves.begin(); It != m_results[strip].m_curves.end(); It++)
+		{
+			CCurve &curve = *It;
+			if(curve.m_vertices.size() < 2)continue;
+			if(first_curve || curve.IsClockwise() == outer_clockwise)
+			{
+				if(first_curve)outer_clockwise = curve.IsClockwise();
+				first_curve = false;
+				m_group_strip.push_back(strip);
+				m_group_parent.push_back((int)m_group_parent.size());
+				m_group_on_seam.push_back(false);
+				m_group_clockwise.push_back(curve.IsClockwise());
+				outers.push_back((int)m_curves.size());
+			}
+			m_curves.push_back(&curve);
+			m_curve_group.push_back((int)m_group_strip.size() - 1);
+			m_curve_on_seam.push_back(false);
+		}
+
+		// a hole usually follows its outside, but an engine which links its holes can give back one it didn't link anywhere
+		// so each hole goes with the smallest outside it is in
+		for(unsigned int c = strip_first_curve; c < m_curves.size(); c++)
+		{
+			if(m_curves[c]->IsClockwise() == outer_clockwise)continue;
+			CAreaBox box;
+			m_curves[c]->GetBox(box);
+			const Point &p = m_curves[c]->m_vertices.front().m_p;
+			double best_area = 0.0;
+			for(std::vector<int>::iterator It = outers.begin(); It != outers.end(); It++)
+			{
+				CAreaBox outer_box;
+				m_curves[*It]->GetBox(outer_box);
+				if(outer_box.MinX() > box.MinX() || outer_box.MaxX() < box.MaxX() || outer_box.MinY() > box.MinY() || outer_box.MaxY() < box.MaxY())continue;
+				double area = fabs(m_curves[*It]->GetArea());
+				if((best_area == 0.0 || area < best_area) && InsideLines(p, *m_curves[*It]))
+				{
+					best_area = area;
+					m_curve_group[c] = m_curve_group[*It];
+				}
+			}
+		}
+	}
+
+	// move the ends of the edges along the seams onto the seams, so the strips on each side meet exactly
+	for(unsigned int c = 0; c < m_curves.size(); c++)
+	{
+		int strip = m_group_strip[m_curve_group[c]];
+		std::list<CVertex> &vertices = m_curves[c]->m_vertices;
+		std::vector<int> vertex_seam(vertices.size(), -1);
+		int i = 0;
+		const CVertex* prev_vertex = NULL;
+		for(std::list<CVertex>::const_iterator It = vertices.begin(); It != vertices.end(); It++, i++)
+		{
+			if(prev_vertex)
+			{
+				int seam = SeamOf(prev_vertex->m_p, It->m_p, strip);
+				if(seam != -1)vertex_seam[i - 1] = vertex_seam[i] = seam;
+			}
+			prev_vertex = &(*It);
+		}
+		if(vertices.front().m_p == vertices.back().m_p)
+		{
+			// the first point and the last point are the same one
+			if(vertex_seam.front() == -1)vertex_seam.front() = vertex_seam.back();
+			else vertex_seam.back() = vertex_seam.front();
+		}
+		i = 0;
+		bool moved = false;
+		for(std::list<CVertex>::iterator It = vertices.begin(); It != vertices.end(); It++, i++)
+		{
+			if(vertex_seam[i] == -1)continue;
+			It->m_p.x = m_seams[vertex_seam[i]];
+			moved = true;
+		}
+		if(moved)m_curves[c]->VerticesChanged();
+	}
+
+	// find the edges along the seams
+	m_seam_edges[0].resize(m_seams.size());
+	m_seam_edges[1].resize(m_seams.size());
+	for(unsigned int c = 0; c < m_curves.size(); c++)
+	{
+		int group = m_curve_group[c];
+		int strip = m_group_strip[group];
+		const CVertex* prev_vertex = NULL;
+		for(std::list<CVertex>::const_iterator It = m_curves[c]->m_vertices.begin(); It != m_curves[c]->m_vertices.end(); It++)
+		{
+			const CVertex &vertex = *It;
+			if(prev_vertex)
+			{
+				int seam = SeamOf(prev_vertex->m_p, vertex.m_p, strip);
+				if(seam != -1)
+				{
+					StripSeamEdge edge;
+					edge.m_p0 = prev_vertex->m_p;
+					edge.m_p1 = vertex.m_p;
+					edge.m_group = group;
+					edge.m_user_data = vertex.m_user_data;
+					m_seam_edges[(seam == strip) ? 0 : 1][seam].push_back(edge);
+					m_curve_on_seam[c] = true;
+					m_group_on_seam[group] = true;
+				}
+			}
+			prev_vertex = &vertex;
+		}
+	}
+
+	for(unsigned int seam = 0; seam < m_seams.size(); seam++)
+	{
+		if(!JoinSeam(seam))return false;
+	}
+
+	// the edges of each set of joined groups
+	std::map<int, std::vector<StripJoinEdge> > joined_edges;
+	for(unsigned int c = 0; c < m_curves.size(); c++)
+	{
+		if(!m_curve_on_seam[c])continue;
+		int group = m_curve_group[c];
+		int strip = m_group_strip[group];
+		std::vector<StripJoinEdge> &edges = joined_edges[Root(group)];
+		const CVertex* prev_vertex = NULL;
+		for(std::list<CVertex>::const_iterator It = m_curves[c]->m_vertices.begin(); It != m_curves[c]->m_vertices.end(); It++)
+		{
+			const CVertex &vertex = *It;
+			if(prev_vertex && SeamOf(prev_vertex->m_p, vertex.m_p, strip) == -1 && (prev_vertex->m_p.x != vertex.m_p.x || prev_vertex->m_p.y != vertex.m_p.y))edges.push_back(StripJoinEdge(prev_vertex->m_p, vertex));
+			prev_vertex = &vertex;
+		}
+	}
+	for(std::vector< std::pair<int, StripJoinEdge> >::iterator It = m_remaining_seam_edges.begin(); It != m_remaining_seam_edges.end(); It++)
+	{
+		joined_edges[Root(It->first)].push_back(It->second);
+	}
+
+	// the holes of joined groups, which don't touch a seam themselves, are ordered with the joined curves
+	std::map<int, std::list<CCurve> > joined_holes;
+	for(unsigned int c = 0; c < m_curves.size(); c++)
+	{
+		int group = m_curve_group[c];
+		if(m_curve_on_seam[c] || !m_group_on_seam[group])continue;
+		joined_holes[Root(group)].push_back(*m_curves[c]);
+	}
+
+	std::map<int, std::list<CCurve> > joined_curves;
+	for(std::map<int, std::vector<StripJoinEdge> >::iterator It = joined_edges.begin(); It != joined_edges.end(); It++)
+	{
+		std::list<CCurve> curves;
+		if(!ChainEdges(It->second, curves))return false;
+
+		// the joined curves can be outsides, holes, and islands in the holes, so they are ordered by which is inside which, not by the way they go round
+		// with an engine which links its holes, a hole and an island in it can come from one linked curve of a strip
+		CArea ordered;
+		for(std::list<CCurve>::iterator CIt = curves.begin(); CIt != curves.end(); CIt++)
+		{
+			if(fabs(CIt->GetArea()) > 0.0)ordered.m_curves.push_back(std::move(*CIt));
+		}
+		ordered.m_curves.splice(ordered.m_curves.end(), joined_holes[It->first]);
+
+		// the ordering and linking use the engine, a curve at a time
+		CAreaSettings settings;
+		CArea::m_strips = 0;
+		CArea::m_fit_arcs = false;
+		ordered.Reorder();
+		std::list<CArea> pieces;
+		ordered.SplitOrdered(pieces);
+
+		bool outer_clockwise = m_group_clockwise[It->first];
+		for(std::list<CArea>::iterator PIt = pieces.begin(); PIt != pieces.end(); PIt++)
+		{
+			CArea &piece = *PIt;
+			if(piece.m_curves.size() > 1 && CArea::HolesLinked())
+			{
+				// a hole went across a seam, or wasn't linked in its strip, let the engine link it to its outside, by taking it away from the outside
+				CArea holes;
+				holes.m_curves.splice(holes.m_curves.end(), piece.m_curves, ++piece.m_curves.begin(), piece.m_curves.end());
+				for(std::list<CCurve>::iterator CIt = holes.m_curves.begin(); CIt != holes.m_curves.end(); CIt++)CIt->Reverse();
+				piece.Subtract(holes);
+			}
+
+			// go round the same way as the strips' results did
+			if((piece.GetArea() > 0.0) != outer_clockwise)
+			{
+				for(std::list<CCurve>::iterator CIt = piece.m_curves.begin(); CIt != piece.m_curves.end(); CIt++)CIt->Reverse();
+			}
+			joined_curves[It->first].splice(joined_curves[It->first].end(), piece.m_curves);
+		}
+		settings.Apply();
+	}
+
+	// keep the order of the strips, with each set of joined groups where its first group was
+	area.m_curves.clear();
+	for(unsigned int c = 0; c < m_curves.size(); c++)
+	{
+		int group = m_curve_group[c];
+		if(!m_group_on_seam[group])
+		{
+			area.m_curves.push_back(std::move(*m_curves[c]));
+			continue;
+		}
+		std::map<int, std::list<CCurve> >::iterator It = joined_curves.find(Root(group));
+		if(It == joined_curves.end())continue; // already added
+		area.m_curves.splice(area.m_curves.end(), It->second);
+		joined_curves.erase(It);
+	}
+
+	if(CArea::m_fit_arcs)
+	{
+		for(std::list<CCurve>::iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)It->FitArcs();
+	}
+
+	return true;
+}
+
+bool CAreaStrips::Do(CArea &area, int operation, const CArea* a2, double value)
+{
+	if(CArea::m_strips < 2)return false;
+	unsigned int num_vertices = NumVertices(area) + (a2 ? NumVertices(*a2) : 0);
+	if(num_vertices < CArea::m_strip_min_vertices)return false;
+
+	// cut the strips where they each get about the same number of vertices
+	std::vector<double> xs;
+	xs.reserve(num_vertices);
+	AddXs(area, xs);
+	if(a2)AddXs(*a2, xs);
+	std::sort(xs.begin(), xs.end());
+	std::vector<double> seams;
+	for(unsigned int i = 1; i < CArea::m_strips; i++)
+	{
+		double x = xs[(size_t)xs.size() * i / CArea::m_strips];
+		if(x > xs.front() && x < xs.back() && (seams.size() == 0 || x > seams.back()))seams.push_back(x);
+	}
+	if(seams.size() == 0)return false;
+
+	CAreaBox box;
+	area.GetBox(box);
+	if(a2)a2->GetBox(box);
+	double pad = 2.0 * fabs(value) + 1.0;
+	double y0 = box.MinY() - pad;
+	double y1 = box.MaxY() + pad;
+
+	int n = (int)seams.size() + 1;
+	std::vector<CArea> results(n);
+	CAreaSettings settings;
+	bool failed = false;
+
+#pragma omp parallel for schedule(dynamic)
+	for(int i = 0; i < n; i++)
+	{
+		settings.Apply();
+		CArea::m_strips = 0; // the strips are done in one go
+		CArea::m_fit_arcs = false; // arcs are fitted after the strips are joined
+		CArea::m_simplify_tolerance = 0.0; // the whole area has already been simplified
+		CArea::m_stats = NULL; // the whole operation is counted by the calling thread
+		try
+		{
+			double x0 = (i == 0) ? (box.MinX() - pad) : seams[i - 1];
+			double x1 = (i == n - 1) ? (box.MaxX() + pad) : seams[i];
+			DoStrip(operation, area, a2, value, x0, x1, y0, y1, results[i]);
+		}
+		catch(...)
+		{
+			// an exception mustn't leave the parallel loop
+			// the engine can fail on a strip's cut curves, when it wouldn't on the whole area
+			failed = true;
+		}
+	}
+
+	settings.Apply(); // the calling thread might have done some strips
+	if(failed)return false;
+
+	CStripJoiner joiner(results, seams);
+	CArea joined;
+	if(!joiner.Join(joined))return false;
+	area.m_curves.swap(joined.m_curves);
+	return true;
+}
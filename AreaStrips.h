@@ -0,0 +1,25 @@
+// AreaStrips.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "Area.h"
+
+class CAreaStrips
+{
+	// Offset and booleans on big areas, done a vertical strip at a time
+	// the strips are cut where they each get about the same number of vertices, and done on separate threads
+	// each strip's result is cut at the strip's edges, then the results are joined back together along those seams
+	// the caller's m_strips and m_strip_min_vertices decide when this is used, see CArea
+public:
+	enum
+	{
+		SubtractOperation,
+		IntersectOperation,
+		UnionOperation,
+		OffsetOperation,
+	};
+
+	// returns false, leaving area as it was, if the areas are too small to cut up, or a strip failed, or the strips couldn't be joined
+	static bool Do(CArea &area, int operation, const CArea* a2, double value = 0.0);
+};
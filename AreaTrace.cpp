@@ -0,0 +1,101 @@
+// AreaTrace.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CAreaTrace, a timeline of the pocketing phases saved as Chrome trace-event JSON
+
+#include "AreaTrace.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> CAreaTrace::m_on(false);
+
+class TraceEvent
+{
+public:
+	const char* m_name;
+	long long m_start;
+	long long m_end;
+};
+
+class TraceThread
+{
+	// each thread adds to its own events, so threads don't wait for each other; the mutex is only shared with Write
+public:
+	int m_id;
+	std::mutex m_mutex;
+	std::vector<TraceEvent> m_events;
+};
+
+static std::mutex threads_mutex;
+static std::vector<std::shared_ptr<TraceThread> > threads; // kept after their threads end, until Start
+static thread_local std::shared_ptr<TraceThread> this_thread;
+static thread_local unsigned int this_thread_generation = 0;
+static std::atomic<unsigned int> generation(0); // Start forgets the threads, this tells each thread to join again
+
+void CAreaTrace::Start()
+{
+	m_on = false;
+	{
+		std::lock_guard<std::mutex> lock(threads_mutex);
+		threads.clear();
+		generation++;
+	}
+	m_on = true;
+}
+
+void CAreaTrace::Stop()
+{
+	m_on = false;
+}
+
+void CAreaTrace::Add(const char* name, long long start, long long end)
+{
+	if(!this_thread || this_thread_generation != generation)
+	{
+		std::lock_guard<std::mutex> lock(threads_mutex);
+		this_thread = std::make_shared<TraceThread>();
+		this_thread->m_id = (int)threads.size() + 1;
+		this_thread_generation = generation;
+		threads.push_back(this_thread);
+	}
+
+	TraceEvent e;
+	e.m_name = name;
+	e.m_start = start;
+	e.m_end = end;
+	std::lock_guard<std::mutex> lock(this_thread->m_mutex);
+	this_thread->m_events.push_back(e);
+}
+
+long long CAreaTrace::Now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool CAreaTrace::Write(const char* filepath)
+{
+	FILE* fp = fopen(filepath, "w");
+	if(fp == NULL)return false;
+
+	// complete events, "X", with the threads numbered in the order they first added one
+	fprintf(fp, "{\"traceEvents\":[\n");
+	bool first = true;
+	std::lock_guard<std::mutex> lock(threads_mutex);
+	for(std::vector<std::shared_ptr<TraceThread> >::iterator It = threads.begin(); It != threads.end(); It++)
+	{
+		TraceThread& thread = **It;
+		std::lock_guard<std::mutex> thread_lock(thread.m_mutex);
+		fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", first ? "" : ",\n", thread.m_id, thread.m_id);
+		first = false;
+		for(std::vector<TraceEvent>::iterator EIt = thread.m_events.begin(); EIt != thread.m_events.end(); EIt++)
+		{
+			const TraceEvent& e = *EIt;
+			fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}", e.m_name, thread.m_id, e.m_start, e.m_end - e.m_start);
+		}
+	}
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	return fclose(fp) == 0;
+}
@@ -0,0 +1,42 @@
+// AreaTrace.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+class CAreaTrace
+{
+	// a timeline of the pocketing phases and booleans, one row per thread, saved as Chrome trace-event JSON
+	// open the file in chrome://tracing or ui.perfetto.dev
+	// when it isn't on, each CAreaTraceScope only reads m_on
+public:
+	static std::atomic<bool> m_on;
+
+	static void Start(); // throws away any events from before
+	static void Stop();
+	static bool Write(const char* filepath); // returns false if the file can't be written
+	static void Add(const char* name, long long start, long long end); // name must stay valid, it is kept as a pointer
+	static long long Now(); // microseconds
+};
+
+class CAreaTraceScope
+{
+	// one event, from when it is made to when it goes out of scope
+	const char* m_name; // NULL if tracing was off
+	long long m_start;
+
+public:
+	CAreaTraceScope(const char* name):m_name(NULL)
+	{
+		if(!CAreaTrace::m_on.load(std::memory_order_relaxed))return;
+		m_name = name;
+		m_start = CAreaTrace::Now();
+	}
+
+	~CAreaTraceScope()
+	{
+		if(m_name)CAreaTrace::Add(m_name, m_start, CAreaTrace::Now());
+	}
+};
@@ -6,7 +6,9 @@
 #include "Circle.h"
 #include "Arc.h"
 #include "Area.h"
+#include "AreaStats.h"
 #include "kurve/geometry.h"
+#include <algorithm>
 
 const Point operator*(const double &d, const Point &p){ return p * d;}
 double Point::tolerance = 0.001;
@@ -51,6 +53,16 @@ CVertex::CVertex(const Point& p, int user_data):m_type(0), m_p(p), m_c(0.0, 0.0)
 
 void CCurve::append(const CVertex& vertex)
 {
+	if(m_vertices.size() > 0)
+	{
+		// keep the remembered values up to date, by adding the new span
+		Span span(m_vertices.back().m_p, vertex);
+		if(m_cache.m_area_valid)m_cache.m_area += span.GetArea();
+		if(m_cache.m_box_valid)span.GetBox(m_cache.m_box);
+		if(m_cache.m_perim_valid)m_cache.m_perim += span.Length();
+		if(vertex.m_type)m_cache.m_polyline = false;
+	}
+	m_cache.m_span_index.reset();
 	m_vertices.push_back(vertex);
 }
 
@@ -181,6 +193,7 @@ void CCurve::AddArcOrLines(bool check_for_arc, std::list<CVertex> &new_vertices,
 
 void CCurve::FitArcs()
 {
+	CAreaStatsScope stats(CAreaStats::FitArcsOperation, *this);
 	std::list<CVertex> new_vertices;
 
 	std::list<const CVertex*> might_be_an_arc;
@@ -215,6 +228,7 @@ void CCurve::FitArcs()
 		m_vertices.clear();
 		for(std::list<CVertex>::iterator It = new_vertices.begin(); It != new_vertices.end(); It++)m_vertices.push_back(*It);
 		for(std::list<const CVertex*>::iterator It = might_be_an_arc.begin(); It != might_be_an_arc.end(); It++)m_vertices.push_back(*(*It));
+		m_cache.Clear();
 	}
 }
 
@@ -311,10 +325,68 @@ void CCurve::UnFitArcs()
 		CVertex vertex(0, pt / CArea::m_units, Point(0.0, 0.0));
 		m_vertices.push_back(vertex);
 	}
+	m_cache.Clear();
+}
+
+static Point NearestPointOnLine(const Point& p0, const Point& p1, const Point& p)
+{
+	// gives the same answer as Span(p0, CVertex(p1)).NearestPoint(p), without making a Span
+	Point vs = p1 - p0;
+	double length = vs.normalize();
+	Point np = (vs * ((p - p0) * vs)) + p0;
+	double t = (vs * (np - p0)) / length;
+	if(t >= 0.0 && t <= 1.0)return np;
+
+	if(p.dist(p0) < p.dist(p1))return p0;
+	return p1;
+}
+
+bool CCurve::IsPolyline()const
+{
+	if(!m_cache.m_polyline_valid)
+	{
+		// the first vertex is only a start point, its type doesn't matter
+		m_cache.m_polyline = true;
+		for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
+		{
+			if(It != m_vertices.begin() && It->m_type)
+			{
+				m_cache.m_polyline = false;
+				break;
+			}
+		}
+		m_cache.m_polyline_valid = true;
+	}
+	return m_cache.m_polyline;
 }
 
 Point CCurve::NearestPoint(const Point& p)const
 {
+	if(IsPolyline())
+	{
+		double best_dist = 0.0;
+		Point best_point = Point(0, 0);
+		bool best_point_valid = false;
+		const Point *prev_p = NULL;
+		for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
+		{
+			const Point& vp = It->m_p;
+			if(prev_p)
+			{
+				Point near_point = NearestPointOnLine(*prev_p, vp, p);
+				double dist = near_point.dist(p);
+				if(!best_point_valid || dist < best_dist)
+				{
+					best_dist = dist;
+					best_point = near_point;
+					best_point_valid = true;
+				}
+			}
+			prev_p = &vp;
+		}
+		return best_point;
+	}
+
 	double best_dist = 0.0;
 	Point best_point = Point(0, 0);
 	bool best_point_valid = false;
@@ -372,20 +444,38 @@ Point CCurve::NearestPoint(const CCurve& c, double *d)const
 	return best_point;
 }
 
-void CCurve::GetBox(CAreaBox &box)
+void CCurve::GetBox(CAreaBox &box)const
 {
-	Point prev_p = Point(0, 0);
-	bool prev_p_valid = false;
-	for(std::list<CVertex>::iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
+	if(!m_cache.m_box_valid && IsPolyline())
 	{
-		CVertex& vertex = *It;
-		if(prev_p_valid)
+		// a line span's box is just its end points
+		m_cache.m_box = CAreaBox();
+		if(m_vertices.size() > 1)
 		{
-			Span(prev_p, vertex).GetBox(box);
+			for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)m_cache.m_box.Insert(It->m_p);
 		}
-		prev_p = vertex.m_p;
-		prev_p_valid = true;
+		m_cache.m_box_valid = true;
 	}
+
+	if(!m_cache.m_box_valid)
+	{
+		m_cache.m_box = CAreaBox();
+		Point prev_p = Point(0, 0);
+		bool prev_p_valid = false;
+		for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
+		{
+			const CVertex& vertex = *It;
+			if(prev_p_valid)
+			{
+				Span(prev_p, vertex).GetBox(m_cache.m_box);
+			}
+			prev_p = vertex.m_p;
+			prev_p_valid = true;
+		}
+		m_cache.m_box_valid = true;
+	}
+
+	box.Insert(m_cache.m_box);
 }
 
 void CCurve::Reverse()
@@ -409,24 +499,47 @@ void CCurve::Reverse()
 		prev_v = &v;
 	}
 
-	m_vertices = new_vertices;
+	m_vertices.swap(new_vertices);
+
+	// the same box and perimeter, the other way round
+	if(m_cache.m_area_valid)m_cache.m_area = -m_cache.m_area;
+	m_cache.m_span_index.reset();
 }
 
-double CCurve::GetArea()const
-{
+double CCurve::GetArea()const
+{
+	if(m_cache.m_area_valid)return m_cache.m_area;
+
 	double area = 0.0;
-	Point prev_p = Point(0, 0);
-	bool prev_p_valid = false;
-	for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
+	if(IsPolyline())
 	{
-		const CVertex& vertex = *It;
-		if(prev_p_valid)
+		// the same sum as Span::GetArea gives for lines
+		const Point *prev_p = NULL;
+		for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
 		{
-			area += Span(prev_p, vertex).GetArea();
+			const Point& p = It->m_p;
+			if(prev_p)area += 0.5 * (p.x - prev_p->x) * (prev_p->y + p.y);
+			prev_p = &p;
+		}
+	}
+	else
+	{
+		Point prev_p = Point(0, 0);
+		bool prev_p_valid = false;
+		for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
+		{
+			const CVertex& vertex = *It;
+			if(prev_p_valid)
+			{
+				area += Span(prev_p, vertex).GetArea();
+			}
+			prev_p = vertex.m_p;
+			prev_p_valid = true;
 		}
-		prev_p = vertex.m_p;
-		prev_p_valid = true;
 	}
+
+	m_cache.m_area = area;
+	m_cache.m_area_valid = true;
 	return area;
 }
 
@@ -437,6 +550,12 @@ bool CCurve::IsClosed()const
 }
 
 void CCurve::ChangeStart(const Point &p) {
+	if(m_cache.m_span_index)
+	{
+		ChangeStart(p, *m_cache.m_span_index);
+		return;
+	}
+
 	CCurve new_curve;
 
 	bool started = false;
@@ -502,8 +621,46 @@ void CCurve::ChangeStart(const Point &p) {
 	}
 }
 
+void CCurve::ChangeStart(const Point &p, const CCurveSpanIndex& index) {
+	// does the same as the loops above, but finds the start span with the index
+	int start_span = index.FirstSpanOn(p);
+	if(start_span < 0)return;
+	const Span& span = index.GetSpan(start_span);
+	if(p == span.m_p)return; // already starts there, the loops above don't finish
+
+	CCurve new_curve;
+	new_curve.m_vertices.push_back(CVertex(p));
+	if(p != span.m_v.m_p)new_curve.m_vertices.push_back(span.m_v);
+	for(int i = start_span + 1; i < index.NumSpans(); i++)new_curve.m_vertices.push_back(index.GetSpan(i).m_v);
+	for(int i = 0; i < start_span; i++)new_curve.m_vertices.push_back(index.GetSpan(i).m_v);
+	if(p == span.m_v.m_p)new_curve.m_vertices.push_back(span.m_v);
+	else
+	{
+		CVertex v(span.m_v);
+		v.m_p = p;
+		new_curve.m_vertices.push_back(v);
+	}
+
+	*this = new_curve;
+}
+
 void CCurve::Break(const Point &p) {
 	// inserts a point, if it lies on the curve
+	if(m_cache.m_span_index)
+	{
+		int span_index = m_cache.m_span_index->FirstSpanOn(p);
+		if(span_index < 0)return;
+		const Span& span = m_cache.m_span_index->GetSpan(span_index);
+		if(p == span.m_p || p == span.m_v.m_p)return; // point is already on a vertex
+		CVertex v(span.m_v);
+		v.m_p = p;
+		std::list<CVertex>::iterator VIt = m_vertices.begin();
+		std::advance(VIt, span_index + 1);
+		m_vertices.insert(VIt, v);
+		m_cache.Clear();
+		return;
+	}
+
 	const Point *prev_p = NULL;
 
 	for(std::list<CVertex>::iterator VIt = m_vertices.begin(); VIt != m_vertices.end(); VIt++)
@@ -520,6 +677,7 @@ void CCurve::Break(const Point &p) {
 				CVertex v(vertex);
 				v.m_p = p;
 				m_vertices.insert(VIt, v);
+				m_cache.Clear();
 				break;
 			}
 		}
@@ -551,6 +709,24 @@ void CCurve::ChangeEnd(const Point &p) {
 	// changes the end position of the Kurve, doesn't keep closed kurves closed
 	CCurve new_curve;
 
+	if(m_cache.m_span_index && m_vertices.size() > 0)
+	{
+		// the spans before the first one that p is on, then that one up to p
+		const CCurveSpanIndex& index = *m_cache.m_span_index;
+		int end_span = index.FirstSpanOn(p);
+		int num_whole_spans = (end_span < 0) ? index.NumSpans() : end_span;
+		new_curve.m_vertices.push_back(m_vertices.front());
+		for(int i = 0; i < num_whole_spans; i++)new_curve.m_vertices.push_back(index.GetSpan(i).m_v);
+		if(end_span >= 0)
+		{
+			CVertex v(index.GetSpan(end_span).m_v);
+			v.m_p = p;
+			new_curve.m_vertices.push_back(v);
+		}
+		*this = new_curve;
+		return;
+	}
+
 	const Point *prev_p = NULL;
 
 	for(std::list<CVertex>::const_iterator VIt = m_vertices.begin(); VIt != m_vertices.end(); VIt++)
@@ -615,6 +791,7 @@ Point CCurve::NearestPoint(const Span& p, double *d)const
 static geoff_geometry::Kurve MakeKurve(const CCurve& curve)
 {
 	geoff_geometry::Kurve k;
+	k.Reserve((int)curve.m_vertices.size());
 	for(std::list<CVertex>::const_iterator It = curve.m_vertices.begin(); It != curve.m_vertices.end(); It++)
 	{
 		const CVertex& v = *It;
@@ -659,6 +836,27 @@ bool CCurve::Offset(double leftwards_value)
 	return success;
 }
 
+bool CCurve::Offset(const std::vector<double>& leftwards_values, std::vector<CCurve>& curves)const
+{
+	// offsets the curve by all the values in one go, they share one kurve and are worked out in parallel
+	// returns true if they were all successful
+	geoff_geometry::Kurve k = MakeKurve(*this);
+	std::vector<geoff_geometry::Kurve> kOffsets;
+	std::vector<int> rets;
+	k.OffsetMethod1(leftwards_values, kOffsets, 1, rets);
+
+	bool success = true;
+	curves.clear();
+	curves.resize(leftwards_values.size());
+	for(unsigned int i = 0; i < leftwards_values.size(); i++)
+	{
+		if(rets[i] == 0)curves[i] = MakeCCurve(kOffsets[i]);
+		else success = false;
+	}
+
+	return success;
+}
+
 void CCurve::GetSpans(std::list<Span> &spans)const
 {
 	const Point *prev_p = NULL;
@@ -730,46 +928,67 @@ void CCurve::OffsetForward(double forwards_value, bool refit_arcs)
 		FitArcs(); // find the arcs again
 	else
 		UnFitArcs(); // convert those little arcs added to lines
+
+	m_cache.Clear();
 }
 
 double CCurve::Perim()const
 {
+	if(m_cache.m_perim_valid)return m_cache.m_perim;
+
 	const Point *prev_p = NULL;
 	double perim = 0.0;
+	bool polyline = IsPolyline();
 	for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
 	{
-		const CVertex& vertex = *It;
+		const CVertex& vertex = *It;
 		if(prev_p)
 		{
-			Span span(*prev_p, vertex);
-			perim += span.Length();
-		}
-		prev_p = &(vertex.m_p);
+			if(polyline)perim += prev_p->dist(vertex.m_p);
+			else perim += Span(*prev_p, vertex).Length();
+		}
+		prev_p = &(vertex.m_p);
 	}
 
+	m_cache.m_perim = perim;
+	m_cache.m_perim_valid = true;
 	return perim;
 }
 
 Point CCurve::PerimToPoint(double perim)const
 {
 	if(m_vertices.size() == 0)return Point(0, 0);
+	if(m_cache.m_span_index && m_cache.m_span_index->NumSpans() > 0)return m_cache.m_span_index->PerimToPoint(perim);
 
 	const Point *prev_p = NULL;
 	double kperim = 0.0;
+	bool polyline = IsPolyline();
 	for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
 	{
-		const CVertex& vertex = *It;
-		if(prev_p)
+		const CVertex& vertex = *It;
+		if(prev_p && polyline)
 		{
-			Span span(*prev_p, vertex);
-			double length = span.Length();
+			double length = prev_p->dist(vertex.m_p);
 			if(perim < kperim + length)
 			{
-				Point p = span.MidPerim(perim - kperim);
-				return p;
+				// the same as Span::MidPerim for a line
+				Point vs = vertex.m_p - *prev_p;
+				vs.normalize();
+				return vs * (perim - kperim) + *prev_p;
 			}
-			kperim += length;
-		}
+			kperim += length;
+		}
+		else if(prev_p)
+		{
+			Span span(*prev_p, vertex);
+			double length = span.Length();
+			if(perim < kperim + length)
+			{
+				Point p = span.MidPerim(perim - kperim);
+				return p;
+			}
+			kperim += length;
+		}
 		prev_p = &(vertex.m_p);
 	}
 
@@ -778,6 +997,8 @@ Point CCurve::PerimToPoint(double perim)const
 
 double CCurve::PointToPerim(const Point& p)const
 {
+	if(m_cache.m_span_index)return m_cache.m_span_index->PointToPerim(p);
+
 	double best_dist = 0.0;
 	double perim_at_best_dist = 0.0;
 	Point best_point = Point(0, 0);
@@ -787,11 +1008,24 @@ double CCurve::PointToPerim(const Point& p)const
 
 	const Point *prev_p = NULL;
 	bool first_span = true;
+	bool polyline = IsPolyline();
 	for(std::list<CVertex>::const_iterator It = m_vertices.begin(); It != m_vertices.end(); It++)
 	{
-		const CVertex& vertex = *It;
-		if(prev_p)
+		const CVertex& vertex = *It;
+		if(prev_p && polyline)
 		{
+			Point near_point = NearestPointOnLine(*prev_p, vertex.m_p, p);
+			double dist = near_point.dist(p);
+			if(!best_dist_found || dist < best_dist)
+			{
+				best_dist = dist;
+				perim_at_best_dist = perim + prev_p->dist(near_point);
+				best_dist_found = true;
+			}
+			perim += prev_p->dist(vertex.m_p);
+		}
+		else if(prev_p)
+		{
 			Span span(*prev_p, vertex, first_span);
 			Point near_point = span.NearestPoint(p);
 			first_span = false;
@@ -805,7 +1039,7 @@ double CCurve::PointToPerim(const Point& p)const
 			}
 			perim += span.Length();
 		}
-		prev_p = &(vertex.m_p);
+		prev_p = &(vertex.m_p);
 	}
 	return perim_at_best_dist;
 }
@@ -827,6 +1061,232 @@ void CCurve::operator+=(const CCurve& curve)
 			m_vertices.push_back(vt);
 		}
 	}
+
+	m_cache.Clear();
+}
+
+const CCurveSpanIndex& CCurve::SpanIndex()const
+{
+	if(!m_cache.m_span_index)m_cache.m_span_index = std::make_shared<CCurveSpanIndex>(*this);
+	return *m_cache.m_span_index;
+}
+
+static const int spans_per_index_leaf = 8;
+
+static double BoxDist(const CAreaBox& box, const Point& p)
+{
+	// distance from p to the nearest point in the box, 0.0 if it's inside
+	double dx = 0.0, dy = 0.0;
+	if(p.x < box.m_minxy.x)dx = box.m_minxy.x - p.x;
+	else if(p.x > box.m_maxxy.x)dx = p.x - box.m_maxxy.x;
+	if(p.y < box.m_minxy.y)dy = box.m_minxy.y - p.y;
+	else if(p.y > box.m_maxxy.y)dy = p.y - box.m_maxxy.y;
+	return sqrt(dx*dx + dy*dy);
+}
+
+static double BoxDist(const CAreaBox& b1, const CAreaBox& b2)
+{
+	double dx = 0.0, dy = 0.0;
+	if(b1.m_maxxy.x < b2.m_minxy.x)dx = b2.m_minxy.x - b1.m_maxxy.x;
+	else if(b2.m_maxxy.x < b1.m_minxy.x)dx = b1.m_minxy.x - b2.m_maxxy.x;
+	if(b1.m_maxxy.y < b2.m_minxy.y)dy = b2.m_minxy.y - b1.m_maxxy.y;
+	else if(b2.m_maxxy.y < b1.m_minxy.y)dy = b1.m_minxy.y - b2.m_maxxy.y;
+	return sqrt(dx*dx + dy*dy);
+}
+
+CCurveSpanIndex::CCurveSpanIndex(const CCurve& curve)
+{
+	// add up the lengths in the same order as CCurve::Perim, so the perimeters match
+	const Point *prev_p = NULL;
+	double perim = 0.0;
+	m_perims.push_back(perim);
+	for(std::list<CVertex>::const_iterator It = curve.m_vertices.begin(); It != curve.m_vertices.end(); It++)
+	{
+		const CVertex& vertex = *It;
+		if(prev_p)
+		{
+			m_spans.push_back(Span(*prev_p, vertex, m_spans.size() == 0));
+			perim += m_spans.back().Length();
+			m_perims.push_back(perim);
+		}
+		prev_p = &(vertex.m_p);
+	}
+
+	if(m_spans.size() > 0)MakeBoxes(0, 0, (int)m_spans.size());
+}
+
+void CCurveSpanIndex::MakeBoxes(int node, int start, int end)
+{
+	if((int)m_boxes.size() <= node)m_boxes.resize(node + 1);
+
+	if(end - start <= spans_per_index_leaf)
+	{
+		for(int i = start; i < end; i++)m_spans[i].GetBox(m_boxes[node]);
+		return;
+	}
+
+	int mid = (start + end) / 2;
+	MakeBoxes(2 * node + 1, start, mid);
+	MakeBoxes(2 * node + 2, mid, end);
+	m_boxes[node].Insert(m_boxes[2 * node + 1]);
+	m_boxes[node].Insert(m_boxes[2 * node + 2]);
+}
+
+void CCurveSpanIndex::NearestSpan(int node, int start, int end, const Point& p, int &best_span, Point &best_point, double &best_dist)const
+{
+	// the spans are tried in order, and only replace the best one if strictly nearer, to give the same answer as CCurve::NearestPoint
+	if(best_span >= 0 && BoxDist(m_boxes[node], p) - Point::tolerance > best_dist)return; // none of these can be nearer
+
+	if(end - start <= spans_per_index_leaf)
+	{
+		for(int i = start; i < end; i++)
+		{
+			const Span& span = m_spans[i];
+			Point near_point = span.m_v.m_type ? span.NearestPoint(p) : NearestPointOnLine(span.m_p, span.m_v.m_p, p);
+			double dist = near_point.dist(p);
+			if(best_span < 0 || dist < best_dist)
+			{
+				best_dist = dist;
+				best_point = near_point;
+				best_span = i;
+			}
+		}
+		return;
+	}
+
+	int mid = (start + end) / 2;
+	NearestSpan(2 * node + 1, start, mid, p, best_span, best_point, best_dist);
+	NearestSpan(2 * node + 2, mid, end, p, best_span, best_point, best_dist);
+}
+
+void CCurveSpanIndex::NearestSpan(int node, int start, int end, const Span& p, const CAreaBox& p_box, int &best_span, Point &best_point, double &best_dist)const
+{
+	// Span::NearestPoint can take up to twice the accuracy off its distances, to prefer start spans and midpoints
+	if(best_span >= 0 && BoxDist(m_boxes[node], p_box) - 2 * CArea::m_accuracy - Point::tolerance > best_dist)return;
+
+	if(end - start <= spans_per_index_leaf)
+	{
+		for(int i = start; i < end; i++)
+		{
+			double dist;
+			Point near_point = m_spans[i].NearestPoint(p, &dist);
+			if(best_span < 0 || dist < best_dist)
+			{
+				best_dist = dist;
+				best_point = near_point;
+				best_span = i;
+			}
+		}
+		return;
+	}
+
+	int mid = (start + end) / 2;
+	NearestSpan(2 * node + 1, start, mid, p, p_box, best_span, best_point, best_dist);
+	NearestSpan(2 * node + 2, mid, end, p, p_box, best_span, best_point, best_dist);
+}
+
+int CCurveSpanIndex::FirstSpanOn(int node, int start, int end, const Point& p)const
+{
+	const CAreaBox& box = m_boxes[node];
+	if(p.x < box.m_minxy.x - Point::tolerance || p.x > box.m_maxxy.x + Point::tolerance || p.y < box.m_minxy.y - Point::tolerance || p.y > box.m_maxxy.y + Point::tolerance)return -1;
+
+	if(end - start <= spans_per_index_leaf)
+	{
+		for(int i = start; i < end; i++)
+		{
+			if(m_spans[i].On(p))return i;
+		}
+		return -1;
+	}
+
+	int mid = (start + end) / 2;
+	int span = FirstSpanOn(2 * node + 1, start, mid, p);
+	if(span >= 0)return span;
+	return FirstSpanOn(2 * node + 2, mid, end, p);
+}
+
+int CCurveSpanIndex::SpanAtPerim(double perim)const
+{
+	std::vector<double>::const_iterator It = std::upper_bound(m_perims.begin() + 1, m_perims.end(), perim);
+	if(It == m_perims.end())return -1;
+	return (int)(It - m_perims.begin()) - 1;
+}
+
+int CCurveSpanIndex::FirstSpanOn(const Point& p)const
+{
+	if(m_spans.size() == 0)return -1;
+	return FirstSpanOn(0, 0, (int)m_spans.size(), p);
+}
+
+Point CCurveSpanIndex::NearestPoint(const Point& p, int *span)const
+{
+	int best_span = -1;
+	Point best_point = Point(0, 0);
+	double best_dist = 0.0;
+	if(m_spans.size() > 0)NearestSpan(0, 0, (int)m_spans.size(), p, best_span, best_point, best_dist);
+	if(span)*span = best_span;
+	return best_point;
+}
+
+Point CCurveSpanIndex::NearestPoint(const Span& p, double *d)const
+{
+	int best_span = -1;
+	Point best_point = Point(0, 0);
+	double best_dist = 0.0;
+	if(m_spans.size() > 0)
+	{
+		CAreaBox p_box;
+		p.GetBox(p_box);
+		NearestSpan(0, 0, (int)m_spans.size(), p, p_box, best_span, best_point, best_dist);
+	}
+	if(d)*d = best_dist;
+	return best_point;
+}
+
+Point CCurveSpanIndex::NearestPoint(const CCurve& c, double *d)const
+{
+	// like CCurve::NearestPoint(const CCurve&), but each of c's spans only looks at nearby spans of this curve
+	double best_dist = 0.0;
+	Point best_point = Point(0, 0);
+	bool best_point_valid = false;
+	const Point *prev_p = NULL;
+	bool first_span = true;
+	for(std::list<CVertex>::const_iterator It = c.m_vertices.begin(); It != c.m_vertices.end(); It++)
+	{
+		const CVertex& vertex = *It;
+		if(prev_p)
+		{
+			double dist;
+			Point near_point = NearestPoint(Span(*prev_p, vertex, first_span), &dist);
+			first_span = false;
+			if(!best_point_valid || dist < best_dist)
+			{
+				best_dist = dist;
+				best_point = near_point;
+				best_point_valid = true;
+			}
+		}
+		prev_p = &(vertex.m_p);
+	}
+	if(d)*d = best_dist;
+	return best_point;
+}
+
+Point CCurveSpanIndex::PerimToPoint(double perim)const
+{
+	if(m_spans.size() == 0)return Point(0, 0);
+	int span = SpanAtPerim(perim);
+	if(span < 0)return m_spans.back().m_v.m_p;
+	return m_spans[span].MidPerim(perim - m_perims[span]);
+}
+
+double CCurveSpanIndex::PointToPerim(const Point& p)const
+{
+	int span;
+	Point near_point = NearestPoint(p, &span);
+	if(span < 0)return 0.0;
+	const Span& s = m_spans[span];
+	return m_perims[span] + Span(s.m_p, CVertex(s.m_v.m_type, near_point, s.m_v.m_c)).Length();
 }
 
 const Point Span::null_point = Point(0, 0);
@@ -965,7 +1425,7 @@ static Point QuadrantEndPoint(int i)
 	}
 }
 
-void Span::GetBox(CAreaBox &box)
+void Span::GetBox(CAreaBox &box)const
 {
 	box.Insert(m_p);
 	box.Insert(m_v.m_p);
@@ -986,6 +1446,7 @@ void Span::GetBox(CAreaBox &box)
 		}
 
 		if(qe<qs)qe = qe + 4;
+		else if(qe == qs && (vs ^ ve) * m_v.m_type < 0.0)qe = qe + 4; // starts and ends in the same quadrant, but goes the long way round
 
 		double rad = m_v.m_p.dist(m_v.m_c);
 
@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <list>
+#include <memory>
 #include <math.h>
 #include "Point.h"
 #include "Box.h"
@@ -53,7 +54,7 @@ public:
 	Span(const Point& p, const CVertex& v, bool start_span = false):m_start_span(start_span), m_p(p), m_v(v){}
 	Point NearestPoint(const Point& p)const;
 	Point NearestPoint(const Span& p, double *d = NULL)const;
-	void GetBox(CAreaBox &box);
+	void GetBox(CAreaBox &box)const;
 	double IncludedAngle()const;
 	double GetArea()const;
 	bool On(const Point& p, double* t = NULL)const;
@@ -63,11 +64,73 @@ public:
 	Point GetVector(double fraction)const;
 };
 
+class CCurve;
+
+class CCurveSpanIndex
+{
+	// the spans of a curve, with the perimeter at the start of each span and a tree of their boxes
+	// so perimeter queries take O(log n) and nearest point queries only look at the spans that might be nearest
+	// get one with CCurve::SpanIndex(), it is thrown away when the curve changes
+	std::vector<Span> m_spans;
+	std::vector<double> m_perims; // the perimeter at the start of each span, with the whole perimeter at the end
+	std::vector<CAreaBox> m_boxes; // node n covers a range of spans, its children are 2n+1 and 2n+2
+
+	void MakeBoxes(int node, int start, int end);
+	void NearestSpan(int node, int start, int end, const Point& p, int &best_span, Point &best_point, double &best_dist)const;
+	void NearestSpan(int node, int start, int end, const Span& p, const CAreaBox& p_box, int &best_span, Point &best_point, double &best_dist)const;
+	int FirstSpanOn(int node, int start, int end, const Point& p)const;
+
+public:
+	CCurveSpanIndex(const CCurve& curve);
+
+	int NumSpans()const{return (int)m_spans.size();}
+	const Span& GetSpan(int i)const{return m_spans[i];}
+	double Perim()const{return m_perims.back();}
+	double PerimAtSpan(int i)const{return m_perims[i];}
+	int SpanAtPerim(double perim)const; // the first span which ends further round than perim, or -1 if none
+	int FirstSpanOn(const Point& p)const; // the first span which p is on, or -1
+	Point NearestPoint(const Point& p, int *span = NULL)const;
+	Point NearestPoint(const Span& p, double *d = NULL)const;
+	Point NearestPoint(const CCurve& c, double *d = NULL)const;
+	Point PerimToPoint(double perim)const;
+	double PointToPerim(const Point& p)const;
+};
+
+class CCurveCache
+{
+	// values worked out from a curve's vertices, kept until the curve is changed
+	// copying a curve copies them, moving a curve leaves the old curve with none
+public:
+	bool m_area_valid;
+	double m_area;
+	bool m_box_valid;
+	CAreaBox m_box;
+	bool m_perim_valid;
+	double m_perim;
+	bool m_polyline_valid;
+	bool m_polyline;
+	std::shared_ptr<const CCurveSpanIndex> m_span_index; // only made when asked for, copies of the curve share it
+
+	CCurveCache(){Clear();}
+	CCurveCache(const CCurveCache& c) = default;
+	CCurveCache(CCurveCache&& c):CCurveCache(c){c.Clear();}
+	CCurveCache& operator=(const CCurveCache& c) = default;
+	CCurveCache& operator=(CCurveCache&& c){*this = c; c.Clear(); return *this;}
+
+	void Clear(){m_area_valid = false; m_box_valid = false; m_perim_valid = false; m_polyline_valid = false; m_span_index.reset();}
+};
+
 class CCurve
 {
 	// a closed curve, please make sure you add an end point, the same as the start point
+	// GetArea, IsClockwise, GetBox and Perim are remembered until the curve is changed by one of its functions
+	// if you change m_vertices directly, call VerticesChanged() afterwards
+	// the remembered values are worked out by const functions, so don't query one curve from two threads at once
 
 protected:
+	mutable CCurveCache m_cache;
+	void ChangeStart(const Point &p, const CCurveSpanIndex& index);
+
 	bool CheckForArc(const CVertex& prev_vt, std::list<const CVertex*>& might_be_an_arc, Arc &arc);
 	void AddArcOrLines(bool check_for_arc, std::list<CVertex> &new_vertices, std::list<const CVertex*>& might_be_an_arc, Arc &arc, bool &arc_found, bool &arc_added);
 
@@ -78,20 +141,24 @@ public:
 	CCurve():m_recur_depth(0){}
 
 	void append(const CVertex& vertex);
+	void VerticesChanged(){m_cache.Clear();}
+	const CCurveSpanIndex& SpanIndex()const; // made the first time it's asked for, after that PerimToPoint, PointToPerim, ChangeStart, ChangeEnd and Break use it too
 
 	void FitArcs();
 	void UnFitArcs();
 	Point NearestPoint(const Point& p)const;
 	Point NearestPoint(const CCurve& p, double *d = NULL)const;
 	Point NearestPoint(const Span& p, double *d = NULL)const;
-	void GetBox(CAreaBox &box);
+	void GetBox(CAreaBox &box)const;
 	void Reverse();
 	double GetArea()const;
 	bool IsClockwise()const{return GetArea()>0;}
+	bool IsPolyline()const; // true if there are no arcs, then the span loops can use simpler line code
 	bool IsClosed()const;
 	void ChangeStart(const Point &p);
 	void ChangeEnd(const Point &p);
 	bool Offset(double leftwards_value);
+	bool Offset(const std::vector<double>& leftwards_values, std::vector<CCurve>& curves)const; // curves gets an offset for each value, or an empty curve where it failed
 	void OffsetForward(double forwards_value, bool refit_arcs = true); // for drag-knife compensation
 	void Break(const Point &p);
 	double Perim()const;
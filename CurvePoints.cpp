@@ -0,0 +1,216 @@
+// CurvePoints.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// implements CCurvePoints, batch queries on a curve's points
+
+#include "CurvePoints.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CURVE_POINTS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+CCurvePoints::CCurvePoints(const CCurve& curve)
+{
+	m_x.reserve(curve.m_vertices.size());
+	m_y.reserve(curve.m_vertices.size());
+	for(std::list<CVertex>::const_iterator It = curve.m_vertices.begin(); It != curve.m_vertices.end(); It++)
+	{
+		m_x.push_back(It->m_p.x);
+		m_y.push_back(It->m_p.y);
+	}
+
+	for(unsigned int i = 1; i < m_x.size(); i++)
+	{
+		Point v(m_x[i] - m_x[i-1], m_y[i] - m_y[i-1]);
+		m_length.push_back(v.normalize());
+		m_ux.push_back(v.x);
+		m_uy.push_back(v.y);
+	}
+}
+
+double CCurvePoints::GetArea()const
+{
+	int n = (int)m_x.size();
+	const double* x = n ? &m_x[0] : NULL;
+	const double* y = n ? &m_y[0] : NULL;
+	double area = 0.0;
+	int i = 0;
+
+#ifdef CURVE_POINTS_USE_SSE2
+	__m128d sum = _mm_setzero_pd();
+	for(; i + 2 < n; i += 2)
+	{
+		__m128d x0 = _mm_loadu_pd(x + i);
+		__m128d x1 = _mm_loadu_pd(x + i + 1);
+		__m128d y0 = _mm_loadu_pd(y + i);
+		__m128d y1 = _mm_loadu_pd(y + i + 1);
+		sum = _mm_add_pd(sum, _mm_mul_pd(_mm_sub_pd(x1, x0), _mm_add_pd(y0, y1)));
+	}
+	double sums[2];
+	_mm_storeu_pd(sums, sum);
+	area = sums[0] + sums[1];
+#endif
+
+	for(; i + 1 < n; i++)area += (x[i+1] - x[i]) * (y[i] + y[i+1]);
+
+	return 0.5 * area;
+}
+
+void CCurvePoints::GetBox(CAreaBox &box)const
+{
+	// like CCurve::GetBox, there's no box unless there's at least one line
+	int n = (int)m_x.size();
+	if(n < 2)return;
+	const double* x = &m_x[0];
+	const double* y = &m_y[0];
+	double minx = x[0], miny = y[0], maxx = x[0], maxy = y[0];
+	int i = 0;
+
+#ifdef CURVE_POINTS_USE_SSE2
+	__m128d vminx = _mm_set1_pd(minx), vminy = _mm_set1_pd(miny), vmaxx = _mm_set1_pd(maxx), vmaxy = _mm_set1_pd(maxy);
+	for(; i + 1 < n; i += 2)
+	{
+		__m128d vx = _mm_loadu_pd(x + i);
+		__m128d vy = _mm_loadu_pd(y + i);
+		vminx = _mm_min_pd(vminx, vx);
+		vminy = _mm_min_pd(vminy, vy);
+		vmaxx = _mm_max_pd(vmaxx, vx);
+		vmaxy = _mm_max_pd(vmaxy, vy);
+	}
+	double a[2];
+	_mm_storeu_pd(a, vminx); minx = (a[0] < a[1]) ? a[0] : a[1];
+	_mm_storeu_pd(a, vminy); miny = (a[0] < a[1]) ? a[0] : a[1];
+	_mm_storeu_pd(a, vmaxx); maxx = (a[0] > a[1]) ? a[0] : a[1];
+	_mm_storeu_pd(a, vmaxy); maxy = (a[0] > a[1]) ? a[0] : a[1];
+#endif
+
+	for(; i < n; i++)
+	{
+		if(x[i] < minx)minx = x[i];
+		if(y[i] < miny)miny = y[i];
+		if(x[i] > maxx)maxx = x[i];
+		if(y[i] > maxy)maxy = y[i];
+	}
+
+	box.Insert(Point(minx, miny));
+	box.Insert(Point(maxx, maxy));
+}
+
+static inline void NearestPointOnLine(double px, double py, double x0, double y0, double x1, double y1, double ux, double uy, double length, double &nx, double &ny, double &dist)
+{
+	// the same sums as Span::NearestPoint does for a line, so it gives exactly the same answer
+	double dp = (px - x0) * ux + (py - y0) * uy;
+	nx = ux * dp + x0;
+	ny = uy * dp + y0;
+	double t = (ux * (nx - x0) + uy * (ny - y0)) / length;
+	if(!(t >= 0.0 && t <= 1.0))
+	{
+		double d0 = sqrt((x0 - px) * (x0 - px) + (y0 - py) * (y0 - py));
+		double d1 = sqrt((x1 - px) * (x1 - px) + (y1 - py) * (y1 - py));
+		if(d0 < d1){nx = x0; ny = y0;}
+		else{nx = x1; ny = y1;}
+	}
+	dist = sqrt((px - nx) * (px - nx) + (py - ny) * (py - ny));
+}
+
+Point CCurvePoints::NearestPoint(const Point& p, double *d)const
+{
+	// the first of the nearest lines is used, like the loop in CCurve::NearestPoint
+	int num_lines = (int)m_length.size();
+	int best_line = -1;
+	double best_dist = 0.0;
+	double best_x = 0.0, best_y = 0.0;
+	int i = 0;
+
+#ifdef CURVE_POINTS_USE_SSE2
+	if(num_lines >= 2)
+	{
+		// each half keeps its own best line, the even lines in one and the odd lines in the other
+		const __m128d zero = _mm_setzero_pd();
+		const __m128d one = _mm_set1_pd(1.0);
+		const __m128d px = _mm_set1_pd(p.x);
+		const __m128d py = _mm_set1_pd(p.y);
+		__m128d vbest_dist = _mm_set1_pd(0.0);
+		__m128d vbest_x = zero, vbest_y = zero, vbest_line = _mm_set1_pd(-1.0);
+		__m128d vline = _mm_set_pd(1.0, 0.0);
+		const __m128d two = _mm_set1_pd(2.0);
+
+		for(; i + 1 < num_lines; i += 2)
+		{
+			__m128d x0 = _mm_loadu_pd(&m_x[i]);
+			__m128d y0 = _mm_loadu_pd(&m_y[i]);
+			__m128d x1 = _mm_loadu_pd(&m_x[i + 1]);
+			__m128d y1 = _mm_loadu_pd(&m_y[i + 1]);
+			__m128d ux = _mm_loadu_pd(&m_ux[i]);
+			__m128d uy = _mm_loadu_pd(&m_uy[i]);
+			__m128d length = _mm_loadu_pd(&m_length[i]);
+
+			__m128d dp = _mm_add_pd(_mm_mul_pd(_mm_sub_pd(px, x0), ux), _mm_mul_pd(_mm_sub_pd(py, y0), uy));
+			__m128d nx = _mm_add_pd(_mm_mul_pd(ux, dp), x0);
+			__m128d ny = _mm_add_pd(_mm_mul_pd(uy, dp), y0);
+			__m128d t = _mm_div_pd(_mm_add_pd(_mm_mul_pd(ux, _mm_sub_pd(nx, x0)), _mm_mul_pd(uy, _mm_sub_pd(ny, y0))), length);
+			__m128d on_line = _mm_and_pd(_mm_cmpge_pd(t, zero), _mm_cmple_pd(t, one));
+
+			__m128d dx0 = _mm_sub_pd(x0, px), dy0 = _mm_sub_pd(y0, py);
+			__m128d dx1 = _mm_sub_pd(x1, px), dy1 = _mm_sub_pd(y1, py);
+			__m128d d0 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx0, dx0), _mm_mul_pd(dy0, dy0)));
+			__m128d d1 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx1, dx1), _mm_mul_pd(dy1, dy1)));
+			__m128d use_start = _mm_cmplt_pd(d0, d1);
+			__m128d ex = _mm_or_pd(_mm_and_pd(use_start, x0), _mm_andnot_pd(use_start, x1));
+			__m128d ey = _mm_or_pd(_mm_and_pd(use_start, y0), _mm_andnot_pd(use_start, y1));
+			nx = _mm_or_pd(_mm_and_pd(on_line, nx), _mm_andnot_pd(on_line, ex));
+			ny = _mm_or_pd(_mm_and_pd(on_line, ny), _mm_andnot_pd(on_line, ey));
+
+			__m128d dx = _mm_sub_pd(px, nx), dy = _mm_sub_pd(py, ny);
+			__m128d dist = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+
+			__m128d better = _mm_or_pd(_mm_cmplt_pd(vbest_line, zero), _mm_cmplt_pd(dist, vbest_dist));
+			vbest_dist = _mm_or_pd(_mm_and_pd(better, dist), _mm_andnot_pd(better, vbest_dist));
+			vbest_x = _mm_or_pd(_mm_and_pd(better, nx), _mm_andnot_pd(better, vbest_x));
+			vbest_y = _mm_or_pd(_mm_and_pd(better, ny), _mm_andnot_pd(better, vbest_y));
+			vbest_line = _mm_or_pd(_mm_and_pd(better, vline), _mm_andnot_pd(better, vbest_line));
+			vline = _mm_add_pd(vline, two);
+		}
+
+		double dists[2], xs[2], ys[2], lines[2];
+		_mm_storeu_pd(dists, vbest_dist);
+		_mm_storeu_pd(xs, vbest_x);
+		_mm_storeu_pd(ys, vbest_y);
+		_mm_storeu_pd(lines, vbest_line);
+
+		// the nearer half, or the one with the earlier line if they're the same distance
+		int h = (dists[1] < dists[0] || (dists[1] == dists[0] && lines[1] < lines[0])) ? 1 : 0;
+		best_line = (int)lines[h];
+		best_dist = dists[h];
+		best_x = xs[h];
+		best_y = ys[h];
+	}
+#endif
+
+	for(; i < num_lines; i++)
+	{
+		double nx, ny, dist;
+		NearestPointOnLine(p.x, p.y, m_x[i], m_y[i], m_x[i + 1], m_y[i + 1], m_ux[i], m_uy[i], m_length[i], nx, ny, dist);
+		if(best_line < 0 || dist < best_dist)
+		{
+			best_line = i;
+			best_dist = dist;
+			best_x = nx;
+			best_y = ny;
+		}
+	}
+
+	if(d)*d = best_dist;
+	return Point(best_x, best_y);
+}
+
+void CCurvePoints::NearestPoints(const std::vector<Point>& points, std::vector<Point>& nearest, std::vector<double>* dists)const
+{
+	nearest.resize(points.size());
+	if(dists)dists->resize(points.size());
+	for(unsigned int i = 0; i < points.size(); i++)
+	{
+		nearest[i] = NearestPoint(points[i], dists ? &((*dists)[i]) : NULL);
+	}
+}
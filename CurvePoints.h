@@ -0,0 +1,27 @@
+// CurvePoints.h
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "Curve.h"
+
+class CCurvePoints
+{
+	// the points of a curve with no arcs, copied into separate x and y arrays
+	// so that batches of queries can be done with SSE2, two lines at a time, where the compiler has it
+	// make one of these to do many queries on the same curve, it doesn't change when the curve changes
+	std::vector<double> m_x;
+	std::vector<double> m_y;
+	std::vector<double> m_ux; // unit vector along each line, worked out as Point::normalize does it
+	std::vector<double> m_uy;
+	std::vector<double> m_length; // length of each line
+
+public:
+	CCurvePoints(const CCurve& curve); // the curve's arcs are treated as lines, check curve.IsPolyline() first
+
+	int NumPoints()const{return (int)m_x.size();}
+	double GetArea()const; // the sum can be added up in a different order to CCurve::GetArea, so may differ in the last bits
+	void GetBox(CAreaBox &box)const;
+	Point NearestPoint(const Point& p, double *d = NULL)const; // the same answer as CCurve::NearestPoint
+	void NearestPoints(const std::vector<Point>& points, std::vector<Point>& nearest, std::vector<double>* dists = NULL)const;
+};
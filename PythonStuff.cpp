@@ -7,6 +7,12 @@
 #include "Area.h"
 #include "Point.h"
 #include "AreaDxf.h"
+#include "AreaIncrementalPocket.h"
+#include "AreaPocketJob.h"
+#include "AreaPocketPreview.h"
+#include "AreaStats.h"
+#include "AreaTrace.h"
+#include "CurvePoints.h"
 
 #if _DEBUG
 #undef _DEBUG
@@ -35,6 +41,24 @@ using namespace clipper;
 
 namespace bp = boost::python;
 
+class ReleaseGIL
+{
+	// lets other Python threads run while the C++ code is busy, don't touch any Python objects while one of these exists
+	PyThreadState* m_thread_state;
+public:
+	ReleaseGIL(){m_thread_state = PyEval_SaveThread();}
+	~ReleaseGIL(){PyEval_RestoreThread(m_thread_state);}
+};
+
+class UseProgress
+{
+	// reports this thread's processing to the given progress, or to the thread's own one if NULL
+	CAreaProgress* m_saved_progress;
+public:
+	UseProgress(CAreaProgress* progress):m_saved_progress(CArea::m_progress){if(progress)CArea::m_progress = progress;}
+	~UseProgress(){CArea::m_progress = m_saved_progress;}
+};
+
 boost::python::list getVertices(const CCurve& curve) {
 	boost::python::list vlist;
 	BOOST_FOREACH(const CVertex& vertex, curve.m_vertices) {
@@ -91,6 +115,7 @@ static CVertex LastVertex(const CCurve& curve)
 
 static void set_units(double units)
 {
+	// only sets the units for the calling thread
 	CArea::m_units = units;
 }
 
@@ -99,6 +124,111 @@ static double get_units()
 	return CArea::m_units;
 }
 
+static void set_strips(unsigned int strips, unsigned int min_vertices)
+{
+	// only for the calling thread, Offset and booleans with at least min_vertices vertices are done in this many strips, 0 turns it off
+	CArea::m_strips = strips;
+	CArea::m_strip_min_vertices = min_vertices;
+}
+
+static unsigned int get_strips()
+{
+	return CArea::m_strips;
+}
+
+static void set_arc_booleans(bool arc_booleans)
+{
+	// only for the calling thread, Offset and booleans are first tried on the arcs themselves, without making polygons
+	CArea::m_arc_booleans = arc_booleans;
+}
+
+static bool get_arc_booleans()
+{
+	return CArea::m_arc_booleans;
+}
+
+static void set_simplify_tolerance(double tolerance)
+{
+	// only for the calling thread, Offset and MakePocketToolpath first remove vertices less than this from the curve without them, 0 turns it off
+	CArea::m_simplify_tolerance = tolerance;
+}
+
+static double get_simplify_tolerance()
+{
+	return CArea::m_simplify_tolerance;
+}
+
+static bp::tuple get_simplify_counts()
+{
+	// the vertices that have gone in to and come out of Simplify, on the calling thread, since reset_simplify_counts
+	return bp::make_tuple(CArea::m_simplify_vertices_in, CArea::m_simplify_vertices_out);
+}
+
+static void reset_simplify_counts()
+{
+	CArea::m_simplify_vertices_in = 0;
+	CArea::m_simplify_vertices_out = 0;
+}
+
+static void set_cache_size(unsigned int max_results)
+{
+	// the cache is shared by all threads, 0 turns it off
+	CArea::SetCacheSize(max_results);
+}
+
+static unsigned int get_cache_size()
+{
+	return CArea::GetCacheSize();
+}
+
+static bp::dict StatsDict(const CAreaStats& stats)
+{
+	// {operation name: {"calls":, "vertices_in":, "vertices_out":, "seconds":, "peak_bytes":}}
+	bp::dict d;
+	for(int i = 0; i < CAreaStats::NumOperations; i++)
+	{
+		CAreaStats::Counts counts = stats.Get(i);
+		bp::dict c;
+		c["calls"] = counts.m_calls;
+		c["vertices_in"] = counts.m_vertices_in;
+		c["vertices_out"] = counts.m_vertices_out;
+		c["seconds"] = counts.m_seconds;
+		c["peak_bytes"] = counts.m_peak_bytes;
+		d[CAreaStats::OperationName(i)] = c;
+	}
+	return d;
+}
+
+static bp::dict get_stats()
+{
+	// of the operations done by the calling thread, since reset_stats
+	if(CArea::m_stats == NULL)return bp::dict();
+	return StatsDict(*CArea::m_stats);
+}
+
+static void reset_stats()
+{
+	if(CArea::m_stats)CArea::m_stats->Reset();
+}
+
+static void start_trace()
+{
+	// every thread's Offsets, booleans and pocketing phases are timed, until stop_trace
+	CAreaTrace::Start();
+}
+
+static void stop_trace()
+{
+	CAreaTrace::Stop();
+}
+
+static bool write_trace(const char* filepath)
+{
+	// as Chrome trace-event JSON, for chrome://tracing or ui.perfetto.dev
+	ReleaseGIL release_gil;
+	return CAreaTrace::Write(filepath);
+}
+
 static bool holes_linked()
 {
 	return CArea::HolesLinked();
@@ -107,6 +237,7 @@ static bool holes_linked()
 static CArea AreaFromDxf(const char* filepath)
 {
 	CArea area;
+	ReleaseGIL release_gil;
 	AreaDxfRead dxf(&area, filepath);
 	dxf.DoRead();
 	return area;
@@ -114,15 +245,19 @@ static CArea AreaFromDxf(const char* filepath)
 
 static void append_point(CCurve& c, const Point& p)
 {
-	c.m_vertices.push_back(CVertex(p));
+	c.append(CVertex(p));
 }
 
-boost::python::list MakePocketToolpath(const CArea& a, double tool_radius, double extra_offset, double stepover, bool from_center, bool use_zig_zag, double zig_angle)
+boost::python::list MakePocketToolpathWithProgress(const CArea& a, double tool_radius, double extra_offset, double stepover, bool from_center, bool use_zig_zag, double zig_angle, CAreaProgress* progress)
 {
 	std::list<CCurve> toolpath;
 
 	CAreaPocketParams params(tool_radius, extra_offset, stepover, from_center, use_zig_zag ? ZigZagPocketMode : SpiralPocketMode, zig_angle);
-	a.SplitAndMakePocketToolpath(toolpath, params);
+	{
+		ReleaseGIL release_gil;
+		UseProgress use_progress(progress);
+		a.SplitAndMakePocketToolpath(toolpath, params);
+	}
 
 	boost::python::list clist;
 	BOOST_FOREACH(const CCurve& c, toolpath) {
@@ -131,10 +266,19 @@ boost::python::list MakePocketToolpath(const CArea& a, double tool_radius, doubl
 	return clist;
 }
 
-boost::python::list SplitArea(const CArea& a)
+boost::python::list MakePocketToolpath(const CArea& a, double tool_radius, double extra_offset, double stepover, bool from_center, bool use_zig_zag, double zig_angle)
+{
+	return MakePocketToolpathWithProgress(a, tool_radius, extra_offset, stepover, from_center, use_zig_zag, zig_angle, NULL);
+}
+
+boost::python::list SplitAreaWithProgress(const CArea& a, CAreaProgress* progress)
 {
 	std::list<CArea> areas;
-	a.Split(areas);
+	{
+		ReleaseGIL release_gil;
+		UseProgress use_progress(progress);
+		a.Split(areas);
+	}
 
 	boost::python::list alist;
 	BOOST_FOREACH(const CArea& a, areas) {
@@ -143,6 +287,156 @@ boost::python::list SplitArea(const CArea& a)
 	return alist;
 }
 
+boost::python::list SplitArea(const CArea& a)
+{
+	return SplitAreaWithProgress(a, NULL);
+}
+
+static void AreaSubtract(CArea& a, const CArea& a2)
+{
+	ReleaseGIL release_gil;
+	a.Subtract(a2);
+}
+
+static void AreaIntersect(CArea& a, const CArea& a2)
+{
+	ReleaseGIL release_gil;
+	a.Intersect(a2);
+}
+
+static void AreaUnion(CArea& a, const CArea& a2)
+{
+	ReleaseGIL release_gil;
+	a.Union(a2);
+}
+
+static void AreaOffset(CArea& a, double inwards_value)
+{
+	ReleaseGIL release_gil;
+	a.Offset(inwards_value);
+}
+
+static void AreaReorder(CArea& a)
+{
+	ReleaseGIL release_gil;
+	a.Reorder();
+}
+
+static double progress_processing_done(const CAreaProgress& progress)
+{
+	return progress.m_processing_done;
+}
+
+static bool progress_please_abort(const CAreaProgress& progress)
+{
+	return progress.m_please_abort;
+}
+
+static void abort_progress(CAreaProgress& progress)
+{
+	progress.m_please_abort = true;
+}
+
+CAreaPocketJob* StartPocketToolpath(const CArea& a, double tool_radius, double extra_offset, double stepover, bool from_center, bool use_zig_zag, double zig_angle)
+{
+	CAreaPocketParams params(tool_radius, extra_offset, stepover, from_center, use_zig_zag ? ZigZagPocketMode : SpiralPocketMode, zig_angle);
+	CAreaPocketJob* job = new CAreaPocketJob(a, params);
+	job->Start();
+	return job;
+}
+
+static double job_processing_done(const CAreaPocketJob& job)
+{
+	return job.m_progress.m_processing_done;
+}
+
+static void job_wait(CAreaPocketJob& job)
+{
+	ReleaseGIL release_gil;
+	job.Wait();
+}
+
+boost::python::list job_get_new_curves(CAreaPocketJob& job)
+{
+	std::list<CCurve> curves;
+	job.GetNewCurves(curves);
+
+	boost::python::list clist;
+	BOOST_FOREACH(const CCurve& c, curves) {
+		clist.append(c);
+    }
+	return clist;
+}
+
+static bp::dict job_get_stats(const CAreaPocketJob& job)
+{
+	return StatsDict(job.m_stats);
+}
+
+static void job_reset_stats(CAreaPocketJob& job)
+{
+	job.m_stats.Reset();
+}
+
+CAreaIncrementalPocket* NewIncrementalPocket(double tool_radius, double extra_offset, double stepover, bool from_center, bool use_zig_zag, double zig_angle)
+{
+	CAreaPocketParams params(tool_radius, extra_offset, stepover, from_center, use_zig_zag ? ZigZagPocketMode : SpiralPocketMode, zig_angle);
+	return new CAreaIncrementalPocket(params);
+}
+
+boost::python::list IncrementalPocketToolpathWithProgress(CAreaIncrementalPocket& pocket, const CArea& a, CAreaProgress* progress)
+{
+	std::list<CCurve> toolpath;
+	{
+		ReleaseGIL release_gil;
+		UseProgress use_progress(progress);
+		pocket.MakePocketToolpath(a, toolpath);
+	}
+
+	boost::python::list clist;
+	BOOST_FOREACH(const CCurve& c, toolpath) {
+		clist.append(c);
+    }
+	return clist;
+}
+
+boost::python::list IncrementalPocketToolpath(CAreaIncrementalPocket& pocket, const CArea& a)
+{
+	return IncrementalPocketToolpathWithProgress(pocket, a, NULL);
+}
+
+static CAreaBox incremental_pocket_changed_box(const CAreaIncrementalPocket& pocket)
+{
+	return pocket.ChangedBox();
+}
+
+CAreaPocketPreview* NewPocketPreview(double tool_radius, double extra_offset, double stepover, bool from_center, bool use_zig_zag, double zig_angle)
+{
+	CAreaPocketParams params(tool_radius, extra_offset, stepover, from_center, use_zig_zag ? ZigZagPocketMode : SpiralPocketMode, zig_angle);
+	return new CAreaPocketPreview(params);
+}
+
+boost::python::list PocketPreviewToolpathWithProgress(CAreaPocketPreview& preview, const CArea& a, CAreaProgress* progress)
+{
+	std::list<CCurve> toolpath;
+	{
+		ReleaseGIL release_gil;
+		UseProgress use_progress(progress);
+		preview.MakePocketToolpath(a, toolpath);
+	}
+
+	boost::python::list clist;
+	BOOST_FOREACH(const CCurve& c, toolpath) {
+		clist.append(c);
+    }
+	return clist;
+}
+
+boost::python::list PocketPreviewToolpath(CAreaPocketPreview& preview, const CArea& a)
+{
+	return PocketPreviewToolpathWithProgress(preview, a, NULL);
+}
+
 void dxfArea(CArea& area, const char* str)
 {
 	area = CArea();
@@ -167,6 +461,28 @@ boost::python::list getCurveSpans(const CCurve& c)
 	return span_list;
 }
 
+boost::python::list CurveOffsets(const CCurve& c, boost::python::list leftwards_values)
+{
+	// returns a list of offset curves, with None for any offset which failed
+	std::vector<double> values;
+	for(int i = 0; i < bp::len(leftwards_values); i++)
+		values.push_back(bp::extract<double>(leftwards_values[i]));
+
+	std::vector<CCurve> curves;
+	{
+		ReleaseGIL release_gil;
+		c.Offset(values, curves);
+	}
+
+	boost::python::list clist;
+	for(unsigned int i = 0; i < curves.size(); i++)
+	{
+		if(curves[i].m_vertices.size() == 0)clist.append(bp::object());
+		else clist.append(curves[i]);
+	}
+	return clist;
+}
+
 Span getFirstCurveSpan(const CCurve& c)
 {
 	if(c.m_vertices.size() < 2)return Span();
@@ -188,6 +504,40 @@ Span getLastCurveSpan(const CCurve& c)
 	return Span((*VIt).m_p, v, c.m_vertices.size() == 2);
 }
 
+boost::python::list CurveNearestPoints(const CCurve& c, boost::python::list points)
+{
+	// returns a list of the nearest point on the curve to each of the given points
+	std::vector<Point> pts;
+	for(int i = 0; i < bp::len(points); i++)
+		pts.push_back(bp::extract<Point>(points[i]));
+
+	std::vector<Point> nearest;
+	{
+		ReleaseGIL release_gil;
+		if(c.IsPolyline())
+		{
+			CCurvePoints curve_points(c);
+			curve_points.NearestPoints(pts, nearest);
+		}
+		else
+		{
+			for(unsigned int i = 0; i < pts.size(); i++)
+				nearest.push_back(c.NearestPoint(pts[i]));
+		}
+	}
+
+	boost::python::list plist;
+	for(unsigned int i = 0; i < nearest.size(); i++)
+		plist.append(nearest[i]);
+	return plist;
+}
+
+static void MakeSpanIndex(const CCurve& c)
+{
+	// makes PerimToPoint, PointToPerim, ChangeStart, ChangeEnd and Break faster, until the curve is changed
+	c.SpanIndex();
+}
+
 bp::tuple TangentialArc(const Point &p0, const Point &p1, const Point &v0)
 {
   Point c;
@@ -256,6 +606,7 @@ BOOST_PYTHON_MODULE(area) {
         .def("append",&append_point)
         .def("text", &print_curve)
 		.def("NearestPoint", static_cast< Point (CCurve::*)(const Point& p)const >(&CCurve::NearestPoint))
+		.def("NearestPoints", &CurveNearestPoints)
 		.def("Reverse", &CCurve::Reverse)
 		.def("getNumVertices", &num_vertices)
 		.def("FirstVertex", &FirstVertex)
@@ -263,9 +614,10 @@ BOOST_PYTHON_MODULE(area) {
 		.def("GetArea", &CCurve::GetArea)
 		.def("IsClockwise", &CCurve::IsClockwise)
 		.def("IsClosed", &CCurve::IsClosed)
-        .def("ChangeStart",&CCurve::ChangeStart)
+        .def("ChangeStart",static_cast< void (CCurve::*)(const Point&) >(&CCurve::ChangeStart))
         .def("ChangeEnd",&CCurve::ChangeEnd)
-        .def("Offset",&CCurve::Offset)
+        .def("Offset",static_cast< bool (CCurve::*)(double) >(&CCurve::Offset))
+        .def("Offsets",&CurveOffsets)
         .def("OffsetForward",&CCurve::OffsetForward)
         .def("GetSpans",&getCurveSpans)
         .def("GetFirstSpan",&getFirstCurveSpan)
@@ -274,6 +626,7 @@ BOOST_PYTHON_MODULE(area) {
         .def("Perim",&CCurve::Perim)
         .def("PerimToPoint",&CCurve::PerimToPoint)
         .def("PointToPerim",&CCurve::PointToPerim)
+        .def("MakeSpanIndex",&MakeSpanIndex)
 		.def("FitArcs",&CCurve::FitArcs)
         .def("UnFitArcs",&CCurve::UnFitArcs)
     ;
@@ -289,23 +642,84 @@ BOOST_PYTHON_MODULE(area) {
 	bp::class_<CArea>("Area") 
         .def(bp::init<CArea>())
         .def("getCurves", &getCurves)
-        .def("append",&CArea::append)
-        .def("Subtract",&CArea::Subtract)
-        .def("Intersect",&CArea::Intersect)
-        .def("Union",&CArea::Union)
-        .def("Offset",&CArea::Offset)
+        .def("append",static_cast< void (CArea::*)(const CCurve&) >(&CArea::append))
+        .def("Subtract",&AreaSubtract)
+        .def("Intersect",&AreaIntersect)
+        .def("Union",&AreaUnion)
+        .def("Offset",&AreaOffset)
         .def("FitArcs",&CArea::FitArcs)
+        .def("Simplify",&CArea::Simplify)
         .def("text", &print_area)
 		.def("num_curves", &CArea::num_curves)
 		.def("NearestPoint", &CArea::NearestPoint)
 		.def("GetBox", &CArea::GetBox)
-		.def("Reorder", &CArea::Reorder)
+		.def("Reorder", &AreaReorder)
 		.def("MakePocketToolpath", &MakePocketToolpath)
-		.def("Split", &SplitArea);
+		.def("MakePocketToolpath", &MakePocketToolpathWithProgress)
+		.def("Split", &SplitArea)
+		.def("Split", &SplitAreaWithProgress)
+		.def("StartPocketToolpath", &StartPocketToolpath, bp::return_value_policy<bp::manage_new_object>());
+    ;
+
+	bp::class_<CAreaProgress, boost::noncopyable>("Progress") 
+        .add_property("processing_done", &progress_processing_done)
+        .add_property("please_abort", &progress_please_abort)
+		.def("Abort", &abort_progress)
+    ;
+
+	bp::class_<CAreaPocketJob, boost::noncopyable>("PocketJob", bp::no_init) 
+        .add_property("processing_done", &job_processing_done)
+		.def("Abort", &CAreaPocketJob::Abort)
+		.def("Finished", &CAreaPocketJob::Finished)
+		.def("Failed", &CAreaPocketJob::Failed)
+		.def("Wait", &job_wait)
+		.def("GetNewCurves", &job_get_new_curves)
+		.def("GetStats", &job_get_stats)
+		.def("ResetStats", &job_reset_stats)
+    ;
+
+	bp::class_<CAreaIncrementalPocket, boost::noncopyable>("IncrementalPocket", bp::no_init) 
+        .def("__init__", bp::make_constructor(&NewIncrementalPocket))
+		.def("MakePocketToolpath", &IncrementalPocketToolpath)
+		.def("MakePocketToolpath", &IncrementalPocketToolpathWithProgress)
+		.def("Clear", &CAreaIncrementalPocket::Clear)
+		.def("NumRegionsMade", &CAreaIncrementalPocket::NumRegionsMade)
+		.def("NumRegionsKept", &CAreaIncrementalPocket::NumRegionsKept)
+		.def("ChangedBox", &incremental_pocket_changed_box)
+    ;
+
+	bp::class_<CAreaPocketPreview, boost::noncopyable>("PocketPreview", bp::no_init) 
+        .def("__init__", bp::make_constructor(&NewPocketPreview))
+		.def("MakePocketToolpath", &PocketPreviewToolpath)
+		.def("MakePocketToolpath", &PocketPreviewToolpathWithProgress)
+		.def("StepoverUsed", &CAreaPocketPreview::StepoverUsed)
+		.def("Length", &CAreaPocketPreview::Length)
+		.def("LinkLength", &CAreaPocketPreview::LinkLength)
+		.def("MachiningTime", &CAreaPocketPreview::MachiningTime)
+		.def_readwrite("accuracy", &CAreaPocketPreview::m_accuracy)
+		.def_readwrite("simplify_tolerance", &CAreaPocketPreview::m_simplify_tolerance)
+		.def_readwrite("max_stepovers", &CAreaPocketPreview::m_max_stepovers)
+		.def_readwrite("feed_rate", &CAreaPocketPreview::m_feed_rate)
+		.def_readwrite("rapid_rate", &CAreaPocketPreview::m_rapid_rate)
     ;
 
     bp::def("set_units", set_units);
     bp::def("get_units", get_units);
+    bp::def("set_strips", set_strips);
+    bp::def("get_strips", get_strips);
+    bp::def("set_arc_booleans", set_arc_booleans);
+    bp::def("get_arc_booleans", get_arc_booleans);
+    bp::def("set_simplify_tolerance", set_simplify_tolerance);
+    bp::def("get_simplify_tolerance", get_simplify_tolerance);
+    bp::def("get_simplify_counts", get_simplify_counts);
+    bp::def("reset_simplify_counts", reset_simplify_counts);
+    bp::def("get_stats", get_stats);
+    bp::def("reset_stats", reset_stats);
+    bp::def("start_trace", start_trace);
+    bp::def("stop_trace", stop_trace);
+    bp::def("write_trace", write_trace);
+    bp::def("set_cache_size", set_cache_size);
+    bp::def("get_cache_size", get_cache_size);
     bp::def("holes_linked", holes_linked);
     bp::def("AreaFromDxf", AreaFromDxf);
     bp::def("TangentialArc", TangentialArc);
@@ -0,0 +1,373 @@
+// AreaBenchmark.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// times the main CArea operations on made up shapes of different sizes, to spot when an upgrade makes them slower
+// the shapes are made the same way every time, so runs on the same machine can be compared
+//
+// usage: area_benchmark [--min_time=seconds] [--sizes=n,n,...] [filter]
+// only benchmarks with the filter text in their name are run, eg. "area_benchmark Pocket/gear"
+
+#include "Area.h"
+#include "AreaDxf.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <math.h>
+
+static const double PI = 3.1415926535897932;
+
+class Random
+{
+	// a small generator of its own, so the random polygons don't depend on the platform's rand()
+	unsigned int m_seed;
+public:
+	Random(unsigned int seed):m_seed(seed){}
+	double Next(){m_seed = m_seed * 1103515245 + 12345; return ((m_seed >> 8) & 0xffffff) / 16777216.0;} // 0 to 1
+};
+
+struct BenchmarkInput
+{
+	std::string m_shape;
+	int m_size; // the number of vertices asked for, the shapes get roughly this many
+	CArea m_area;
+	CArea m_other; // a second area, overlapping m_area, for the booleans
+	std::string m_dxf_path; // m_area written as a dxf file
+};
+
+typedef void (*BenchmarkFunction)(const BenchmarkInput &input);
+
+static double min_time = 0.5;
+static const char* filter = NULL;
+
+static void AddPolygon(CArea &area, const std::vector<Point> &pts, bool clockwise)
+{
+	CCurve curve;
+	if(clockwise)
+	{
+		for(std::vector<Point>::const_reverse_iterator It = pts.rbegin(); It != pts.rend(); It++)curve.append(*It);
+		curve.append(pts.back());
+	}
+	else
+	{
+		for(std::vector<Point>::const_iterator It = pts.begin(); It != pts.end(); It++)curve.append(*It);
+		curve.append(pts.front());
+	}
+	area.append(curve);
+}
+
+static void AddCircle(CArea &area, const Point &c, double r, bool clockwise)
+{
+	int dir = clockwise ? -1 : 1;
+	CCurve curve;
+	curve.append(Point(c.x + r, c.y));
+	curve.append(CVertex(dir, Point(c.x - r, c.y), c));
+	curve.append(CVertex(dir, Point(c.x + r, c.y), c));
+	area.append(curve);
+}
+
+static void AddRectangle(CArea &area, double x0, double y0, double x1, double y1)
+{
+	std::vector<Point> pts;
+	pts.push_back(Point(x0, y0));
+	pts.push_back(Point(x1, y0));
+	pts.push_back(Point(x1, y1));
+	pts.push_back(Point(x0, y1));
+	AddPolygon(area, pts, false);
+}
+
+static void MakeGear(CArea &area, int size)
+{
+	// a spur gear with 8 vertices per tooth and a round hole in the middle
+	int teeth = size / 8;
+	if(teeth < 6)teeth = 6;
+	double pitch = 2.0;
+	double r = teeth * pitch / PI;
+	double root = r - 1.25, tip = r + 1.0;
+	std::vector<Point> pts;
+	for(int i = 0; i < teeth; i++)
+	{
+		double a = 2 * PI * i / teeth, t = 2 * PI / teeth;
+		double fractions[8] = {0.0, 0.1, 0.25, 0.35, 0.5, 0.6, 0.75, 0.85};
+		double radii[8] = {root, root, tip, tip, root, root, root, root};
+		if(i % 2)radii[6] = radii[7] = root - 0.1;
+		for(int j = 0; j < 8; j++)pts.push_back(Point(radii[j] * cos(a + fractions[j] * t), radii[j] * sin(a + fractions[j] * t)));
+	}
+	AddPolygon(area, pts, false);
+	AddCircle(area, Point(0, 0), r / 4, true);
+}
+
+static void MakePerforatedPlate(CArea &area, int size)
+{
+	// a square plate with a grid of holes, alternately circles and octagons
+	int holes_across = (int)sqrt(size / 6.0);
+	if(holes_across < 2)holes_across = 2;
+	double w = holes_across * 10.0;
+	AddRectangle(area, 0, 0, w, w);
+	for(int i = 0; i < holes_across; i++)
+	{
+		for(int j = 0; j < holes_across; j++)
+		{
+			Point c(5.0 + i * 10.0, 5.0 + j * 10.0);
+			if((i + j) % 2)
+			{
+				AddCircle(area, c, 3.5, true);
+			}
+			else
+			{
+				std::vector<Point> pts;
+				for(int k = 0; k < 8; k++)pts.push_back(c + Point(3.5 * cos(PI * k / 4), 3.5 * sin(PI * k / 4)));
+				AddPolygon(area, pts, true);
+			}
+		}
+	}
+}
+
+static void MakeRandomPolygon(CArea &area, int size)
+{
+	// a star shaped polygon with random radii
+	Random random(size);
+	int n = size;
+	if(n < 8)n = 8;
+	std::vector<Point> pts;
+	for(int i = 0; i < n; i++)
+	{
+		double a = 2 * PI * i / n;
+		double r = 30.0 + 20.0 * random.Next();
+		pts.push_back(Point(r * cos(a), r * sin(a)));
+	}
+	AddPolygon(area, pts, false);
+}
+
+static void MakeText(CArea &area, int size)
+{
+	// seven segment digits, each lit segment a bar, joined up with Union like outlines of text
+	// segments: top, top right, bottom right, bottom, bottom left, top left, middle
+	// the bars overlap without sharing any edges, kbool doesn't like collinear edges
+	static const char* segments_for_digit[10] = {"abcdef", "bc", "abdeg", "abcdg", "bcfg", "acdfg", "acdefg", "abc", "abcdefg", "abcdfg"};
+	int digits = size / 24;
+	if(digits < 1)digits = 1;
+	for(int i = 0; i < digits; i++)
+	{
+		double x = (i % 20) * 8.0, y = -(i / 20) * 14.0;
+		for(const char* s = segments_for_digit[i % 10]; *s; s++)
+		{
+			CArea bar;
+			switch(*s)
+			{
+			case 'a': AddRectangle(bar, x + 0.3, y + 10, x + 5.7, y + 11.2); break;
+			case 'b': AddRectangle(bar, x + 4.8, y + 5.6, x + 6, y + 10.6); break;
+			case 'c': AddRectangle(bar, x + 4.8, y + 0.6, x + 6, y + 5.6); break;
+			case 'd': AddRectangle(bar, x + 0.3, y, x + 5.7, y + 1.2); break;
+			case 'e': AddRectangle(bar, x, y + 0.6, x + 1.2, y + 5.6); break;
+			case 'f': AddRectangle(bar, x, y + 5.6, x + 1.2, y + 10.6); break;
+			case 'g': AddRectangle(bar, x + 0.3, y + 5, x + 5.7, y + 6.2); break;
+			}
+			if(area.m_curves.size() == 0)area = bar; // kbool can't union with nothing
+			else area.Union(bar);
+		}
+	}
+}
+
+static void WriteDxf(const CArea &area, const char* filepath)
+{
+	// lines and arcs only, the way most CAD programs export outlines
+	FILE* fp = fopen(filepath, "w");
+	if(fp == NULL)return;
+	fprintf(fp, "0\nSECTION\n2\nENTITIES\n");
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)
+	{
+		const CCurve& curve = *It;
+		const CVertex* prev_vertex = NULL;
+		for(std::list<CVertex>::const_iterator VIt = curve.m_vertices.begin(); VIt != curve.m_vertices.end(); VIt++)
+		{
+			const CVertex& vertex = *VIt;
+			if(prev_vertex)
+			{
+				if(vertex.m_type == 0)
+				{
+					fprintf(fp, "0\nLINE\n8\n0\n10\n%.6f\n20\n%.6f\n30\n0.0\n11\n%.6f\n21\n%.6f\n31\n0.0\n", prev_vertex->m_p.x, prev_vertex->m_p.y, vertex.m_p.x, vertex.m_p.y);
+				}
+				else
+				{
+					// dxf arcs go anti-clockwise
+					const Point& s = (vertex.m_type == 1) ? prev_vertex->m_p : vertex.m_p;
+					const Point& e = (vertex.m_type == 1) ? vertex.m_p : prev_vertex->m_p;
+					double start_angle = atan2(s.y - vertex.m_c.y, s.x - vertex.m_c.x) * 180 / PI;
+					double end_angle = atan2(e.y - vertex.m_c.y, e.x - vertex.m_c.x) * 180 / PI;
+					fprintf(fp, "0\nARC\n8\n0\n10\n%.6f\n20\n%.6f\n30\n0.0\n40\n%.6f\n50\n%.6f\n51\n%.6f\n", vertex.m_c.x, vertex.m_c.y, vertex.m_c.dist(s), start_angle, end_angle);
+				}
+			}
+			prev_vertex = &vertex;
+		}
+	}
+	fprintf(fp, "0\nENDSEC\n0\nEOF\n");
+	fclose(fp);
+}
+
+static int NumVertices(const CArea &area)
+{
+	int n = 0;
+	for(std::list<CCurve>::const_iterator It = area.m_curves.begin(); It != area.m_curves.end(); It++)n += It->m_vertices.size();
+	return n;
+}
+
+// the benchmarks, each does the operation once on a copy of the input
+
+static void Subtract(const BenchmarkInput &input){CArea a = input.m_area; a.Subtract(input.m_other);}
+static void Union(const BenchmarkInput &input){CArea a = input.m_area; a.Union(input.m_other);}
+static void Intersect(const BenchmarkInput &input){CArea a = input.m_area; a.Intersect(input.m_other);}
+static void OffsetInwards(const BenchmarkInput &input){CArea a = input.m_area; a.Offset(0.3);}
+static void OffsetOutwards(const BenchmarkInput &input){CArea a = input.m_area; a.Offset(-0.3);}
+static void Reorder(const BenchmarkInput &input){CArea a = input.m_area; a.Reorder();}
+static void Split(const BenchmarkInput &input){std::list<CArea> areas; input.m_area.Split(areas);}
+static void FitArcs(const BenchmarkInput &input){CArea a = input.m_area; a.FitArcs();}
+
+static void UnFitArcs(const BenchmarkInput &input)
+{
+	CArea a = input.m_area;
+	for(std::list<CCurve>::iterator It = a.m_curves.begin(); It != a.m_curves.end(); It++)It->UnFitArcs();
+}
+
+static void NearestPoint(const BenchmarkInput &input)
+{
+	// 100 points on a ring around the shape's box
+	CAreaBox box;
+	CArea a = input.m_area;
+	a.GetBox(box);
+	Point c = box.Centre();
+	double r = box.Width() * 0.6;
+	for(int i = 0; i < 100; i++)input.m_area.NearestPoint(c + Point(r * cos(0.0628 * i), r * sin(0.0628 * i)));
+}
+
+static void Pocket(const BenchmarkInput &input, PocketMode mode)
+{
+	std::list<CCurve> toolpath;
+	CAreaPocketParams params(0.25, 0.05, 0.3, false, mode, 30.0);
+	params.only_cut_first_offset = false;
+	input.m_area.SplitAndMakePocketToolpath(toolpath, params);
+}
+
+static void PocketSpiral(const BenchmarkInput &input){Pocket(input, SpiralPocketMode);}
+static void PocketZigZag(const BenchmarkInput &input){Pocket(input, ZigZagPocketMode);}
+static void PocketSingleOffset(const BenchmarkInput &input){Pocket(input, SingleOffsetPocketMode);}
+static void PocketZigZagThenSingleOffset(const BenchmarkInput &input){Pocket(input, ZigZagThenSingleOffsetPocketMode);}
+
+static void DxfImport(const BenchmarkInput &input)
+{
+	CArea a;
+	AreaDxfRead dxf(&a, input.m_dxf_path.c_str());
+	dxf.DoRead();
+}
+
+static void RunBenchmark(const char* name, BenchmarkFunction function, const BenchmarkInput &input)
+{
+	char full_name[256];
+	sprintf(full_name, "%s/%s/%d", name, input.m_shape.c_str(), input.m_size);
+	if(filter && strstr(full_name, filter) == NULL)return;
+
+	// always at least one run, then as many as fit in min_time
+	typedef std::chrono::steady_clock clock;
+	clock::time_point start = clock::now();
+	int iterations = 0;
+	double seconds = 0.0;
+	do
+	{
+		function(input);
+		iterations++;
+		seconds = std::chrono::duration<double>(clock::now() - start).count();
+	}while(seconds < min_time);
+
+	printf("%-50s %14.3f ms %10d\n", full_name, seconds * 1000.0 / iterations, iterations);
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<int> sizes;
+	for(int i = 1; i < argc; i++)
+	{
+		if(strncmp(argv[i], "--min_time=", 11) == 0)min_time = atof(argv[i] + 11);
+		else if(strncmp(argv[i], "--sizes=", 8) == 0)
+		{
+			for(const char* s = argv[i] + 8; *s; s++)
+			{
+				sizes.push_back(atoi(s));
+				s = strchr(s, ',');
+				if(s == NULL)break;
+			}
+		}
+		else filter = argv[i];
+	}
+	if(sizes.size() == 0)
+	{
+		sizes.push_back(64);
+		sizes.push_back(256);
+		sizes.push_back(1024);
+	}
+
+	const char* shape_names[4] = {"gear", "plate", "random", "text"};
+	void (*shape_makers[4])(CArea &area, int size) = {MakeGear, MakePerforatedPlate, MakeRandomPolygon, MakeText};
+
+	struct{const char* name; BenchmarkFunction function;} benchmarks[] = {
+		{"Subtract", Subtract},
+		{"Union", Union},
+		{"Intersect", Intersect},
+		{"OffsetInwards", OffsetInwards},
+		{"OffsetOutwards", OffsetOutwards},
+		{"Reorder", Reorder},
+		{"Split", Split},
+		{"FitArcs", FitArcs},
+		{"UnFitArcs", UnFitArcs},
+		{"NearestPoint", NearestPoint},
+		{"PocketSpiral", PocketSpiral},
+		{"PocketZigZag", PocketZigZag},
+		{"PocketSingleOffset", PocketSingleOffset},
+		{"PocketZigZagThenSingleOffset", PocketZigZagThenSingleOffset},
+		{"DxfImport", DxfImport},
+	};
+
+	printf("%-50s %17s %10s\n", "Benchmark", "Time", "Iterations");
+	for(unsigned int size_index = 0; size_index < sizes.size(); size_index++)
+	{
+		for(int shape = 0; shape < 4; shape++)
+		{
+			BenchmarkInput input;
+			input.m_shape = shape_names[shape];
+			input.m_size = sizes[size_index];
+			shape_makers[shape](input.m_area, input.m_size);
+
+			// the same shape moved a third of its width, to overlap itself
+			CAreaBox box;
+			input.m_area.GetBox(box);
+			input.m_other = input.m_area;
+			double dx = box.Width() / 3, dy = box.Height() / 7;
+			for(std::list<CCurve>::iterator It = input.m_other.m_curves.begin(); It != input.m_other.m_curves.end(); It++)
+			{
+				for(std::list<CVertex>::iterator VIt = It->m_vertices.begin(); VIt != It->m_vertices.end(); VIt++)
+				{
+					VIt->m_p = VIt->m_p + Point(dx, dy);
+					VIt->m_c = VIt->m_c + Point(dx, dy);
+				}
+				It->VerticesChanged();
+			}
+
+			input.m_dxf_path = std::string("area_benchmark_") + input.m_shape + ".dxf";
+			WriteDxf(input.m_area, input.m_dxf_path.c_str());
+
+			if(filter == NULL)printf("# %s with %d vertices\n", input.m_shape.c_str(), NumVertices(input.m_area));
+
+			for(unsigned int i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+			{
+				RunBenchmark(benchmarks[i].name, benchmarks[i].function, input);
+			}
+
+			remove(input.m_dxf_path.c_str());
+		}
+	}
+
+	return 0;
+}
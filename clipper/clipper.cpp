@@ -2019,6 +2019,7 @@ void Clipper::BuildIntersectList(const long64 topY)
   m_SortedEdges = e;
   m_SortedEdges->prevInSEL = 0;
   e = e->nextInAEL;
+  int edgeCount = 1;
   while( e )
   {
     e->prevInSEL = e->prevInAEL;
@@ -2026,6 +2027,17 @@ void Clipper::BuildIntersectList(const long64 topY)
     e->nextInSEL = 0;
     e->tmpX = TopX( *e, topY );
     e = e->nextInAEL;
+    edgeCount++;
+  }
+
+  //with many active edges the bubblesort is too slow, so merge sort them
+  //instead. It only falls back to the bubblesort when two edges swap places
+  //without an intersection point, because then the bubblesort's result
+  //depends on the order of its swaps ...
+  if( edgeCount > 8 && MergeSortIntersections(edgeCount) )
+  {
+    m_SortedEdges = 0;
+    return;
   }
 
   //bubblesort ...
@@ -2076,22 +2088,21 @@ bool Process1Before2(IntersectNode &node1, IntersectNode &node2)
 }
 //------------------------------------------------------------------------------
 
-void Clipper::AddIntersectNode(TEdge *e1, TEdge *e2, const IntPoint &pt)
+void InsertIntersectNode(IntersectNode *&list, IntersectNode *newNode, bool afterHigherNode = false)
 {
-  IntersectNode* newNode = new IntersectNode;
-  newNode->edge1 = e1;
-  newNode->edge2 = e2;
-  newNode->pt = pt;
+  //afterHigherNode is for a list of nodes at one Y that, in the whole list,
+  //come after a node at a higher Y, which changes how the first is compared
   newNode->next = 0;
-  if( !m_IntersectNodes ) m_IntersectNodes = newNode;
-  else if(  Process1Before2(*newNode, *m_IntersectNodes) )
+  if( !list ) list = newNode;
+  else if( afterHigherNode ? !Process1Before2(*list, *newNode) :
+    Process1Before2(*newNode, *list) )
   {
-    newNode->next = m_IntersectNodes;
-    m_IntersectNodes = newNode;
+    newNode->next = list;
+    list = newNode;
   }
   else
   {
-    IntersectNode* iNode = m_IntersectNodes;
+    IntersectNode* iNode = list;
     while( iNode->next  && Process1Before2(*iNode->next, *newNode) )
         iNode = iNode->next;
     newNode->next = iNode->next;
@@ -2100,6 +2111,142 @@ void Clipper::AddIntersectNode(TEdge *e1, TEdge *e2, const IntPoint &pt)
 }
 //------------------------------------------------------------------------------
 
+void Clipper::AddIntersectNode(TEdge *e1, TEdge *e2, const IntPoint &pt)
+{
+  IntersectNode* newNode = new IntersectNode;
+  newNode->edge1 = e1;
+  newNode->edge2 = e2;
+  newNode->pt = pt;
+  InsertIntersectNode( m_IntersectNodes, newNode );
+}
+//------------------------------------------------------------------------------
+
+struct SortedIntersectNode
+{
+  IntersectNode* node;
+  int pos1, pos2; //the edges' places in the AEL, edge1 is left of edge2
+  int pass;       //which pass of the bubblesort would swap them
+};
+
+bool SortedNodeAbove(const SortedIntersectNode &node1, const SortedIntersectNode &node2)
+{
+  return node1.node->pt.Y > node2.node->pt.Y;
+}
+//------------------------------------------------------------------------------
+
+bool SortedNodeBeforeInPass(const SortedIntersectNode *node1, const SortedIntersectNode *node2)
+{
+  //for each edge2, its edge1s in the order the bubblesort carries them past
+  //it, the highest tmpX first, and of equal ones the furthest right first ...
+  if( node1->pos2 != node2->pos2 ) return node1->pos2 < node2->pos2;
+  if( node1->node->edge1->tmpX != node2->node->edge1->tmpX )
+    return node1->node->edge1->tmpX > node2->node->edge1->tmpX;
+  return node1->pos1 > node2->pos1;
+}
+//------------------------------------------------------------------------------
+
+bool SortedNodeBubbledFirst(const SortedIntersectNode &node1, const SortedIntersectNode &node2)
+{
+  //each pass of the bubblesort swaps from left to right ...
+  if( node1.pass != node2.pass ) return node1.pass < node2.pass;
+  return node1.pos2 < node2.pos2;
+}
+//------------------------------------------------------------------------------
+
+bool Clipper::MergeSortIntersections(int edgeCount)
+{
+  //a bottom up merge sort of the active edges on tmpX. When an edge from the
+  //right half of a merge goes before edges still in the left half, it crosses
+  //each of them, so every pair that the bubblesort would swap is found once,
+  //in O(n log n + intersections) ...
+  std::vector< TEdge* > edges;
+  std::vector< int > order(edgeCount), merged(edgeCount);
+  std::vector< SortedIntersectNode > nodes;
+  edges.reserve(edgeCount);
+  for( TEdge* e = m_ActiveEdges; e; e = e->nextInAEL ) edges.push_back(e);
+  for( int i = 0; i < edgeCount; ++i ) order[i] = i;
+
+  for( int width = 1; width < edgeCount; width *= 2 )
+  {
+    for( int lo = 0; lo < edgeCount - width; lo += 2 * width )
+    {
+      int mid = lo + width;
+      int hi = std::min(lo + 2 * width, edgeCount);
+      int i = lo, j = mid, k = lo;
+      while( i < mid && j < hi )
+      {
+        if( edges[order[j]]->tmpX < edges[order[i]]->tmpX )
+        {
+          for( int m = i; m < mid; ++m )
+          {
+            IntPoint pt;
+            if( !IntersectPoint(*edges[order[m]], *edges[order[j]], pt, m_UseFullRange) )
+            {
+              for( size_t n = 0; n < nodes.size(); ++n ) delete nodes[n].node;
+              return false;
+            }
+            SortedIntersectNode sortedNode;
+            sortedNode.node = new IntersectNode;
+            sortedNode.node->edge1 = edges[order[m]];
+            sortedNode.node->edge2 = edges[order[j]];
+            sortedNode.node->pt = pt;
+            sortedNode.pos1 = order[m];
+            sortedNode.pos2 = order[j];
+            sortedNode.pass = 0;
+            nodes.push_back(sortedNode);
+          }
+          merged[k++] = order[j++];
+        }
+        else
+          merged[k++] = order[i++];
+      }
+      while( i < mid ) merged[k++] = order[i++];
+      while( j < hi ) merged[k++] = order[j++];
+      std::copy(merged.begin() + lo, merged.begin() + hi, order.begin() + lo);
+    }
+  }
+
+  //the nodes are processed from the top down ...
+  std::sort(nodes.begin(), nodes.end(), SortedNodeAbove);
+
+  //Process1Before2 orders nodes at the same Y by the order they're added in,
+  //and by whether a node at a higher Y was added before them, so they must be
+  //added in the order the bubblesort would find them. In pass p the
+  //bubblesort carries the p'th highest of the edges left of an edge, that go
+  //after it, past it ...
+  bool sameY = false;
+  for( size_t i = 1; i < nodes.size() && !sameY; ++i )
+    sameY = nodes[i].node->pt.Y == nodes[i - 1].node->pt.Y;
+  if( sameY )
+  {
+    std::vector< SortedIntersectNode* > byEdge2(nodes.size());
+    for( size_t i = 0; i < nodes.size(); ++i ) byEdge2[i] = &nodes[i];
+    std::sort(byEdge2.begin(), byEdge2.end(), SortedNodeBeforeInPass);
+    for( size_t i = 0; i < byEdge2.size(); ++i )
+      byEdge2[i]->pass = ( i > 0 && byEdge2[i - 1]->pos2 == byEdge2[i]->pos2 ) ?
+        byEdge2[i - 1]->pass + 1 : 1;
+  }
+
+  IntersectNode** tail = &m_IntersectNodes;
+  const SortedIntersectNode* firstHigher = 0; //the first found above this Y
+  for( size_t i = 0; i < nodes.size(); )
+  {
+    size_t j = i + 1;
+    while( j < nodes.size() && nodes[j].node->pt.Y == nodes[i].node->pt.Y ) ++j;
+    if( j - i > 1 )
+      std::sort(nodes.begin() + i, nodes.begin() + j, SortedNodeBubbledFirst);
+    const SortedIntersectNode* first = &nodes[i];
+    for( ; i < j; ++i )
+      InsertIntersectNode( *tail, nodes[i].node,
+        firstHigher && SortedNodeBubbledFirst(*firstHigher, nodes[i]) );
+    if( !firstHigher || SortedNodeBubbledFirst(*first, *firstHigher) )
+      firstHigher = first;
+    while( *tail ) tail = &(*tail)->next;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+
 void Clipper::ProcessIntersectList()
 {
   while( m_IntersectNodes )
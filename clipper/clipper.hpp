@@ -211,6 +211,7 @@ private:
   bool ProcessIntersections( const long64 topY);
   void AddIntersectNode(TEdge *e1, TEdge *e2, const IntPoint &pt);
   void BuildIntersectList(const long64 topY);
+  bool MergeSortIntersections(int edgeCount);
   void ProcessIntersectList();
   void ProcessEdgesAtTopOfScanbeam(const long64 topY);
   void BuildResult(Polygons& polypoly);
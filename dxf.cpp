@@ -903,16 +903,16 @@ bool CDxfRead::ReadEllipse()
 }
 
 
-static bool poly_prev_found = false;
-static double poly_prev_x;
-static double poly_prev_y;
-static double poly_prev_z;
-static double poly_prev_bulge_found;
-static double poly_prev_bulge;
-static bool poly_first_found = false;
-static double poly_first_x;
-static double poly_first_y;
-static double poly_first_z;
+static thread_local bool poly_prev_found = false;
+static thread_local double poly_prev_x;
+static thread_local double poly_prev_y;
+static thread_local double poly_prev_z;
+static thread_local double poly_prev_bulge_found;
+static thread_local double poly_prev_bulge;
+static thread_local bool poly_first_found = false;
+static thread_local double poly_first_x;
+static thread_local double poly_first_y;
+static thread_local double poly_first_z;
 
 static void AddPolyLinePoint(CDxfRead* dxf_read, double x, double y, double z, bool bulge_found, double bulge)
 {
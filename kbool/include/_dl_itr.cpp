@@ -2167,62 +2167,126 @@ void DL_Iter<Dtype>::mergesort(int (*fcmp) (Dtype, Dtype))
 {
 	if (_current==0)
 		Error("mergesort()",NO_LIST);
- 	mergesort_rec(fcmp, RT, NB);
+
+   int n = NB;
+   if (n < 2)
+      return;
+
+   // the nodes are sorted in an array and relinked in their new order afterwards,
+   // so the sort doesn't chase _next pointers around the heap.
+   // the halves and merges are the same as sorting the linked list in place,
+   // so the order is the same, even for compare functions which are not consistent
+   std::vector< DL_Node<Dtype>* > nodes(n);
+   std::vector< DL_Node<Dtype>* > buffer(n);
+   DL_Node<Dtype>* node = RT->_next;
+   for (int i = 0; i < n; i++)
+   {
+      nodes[i] = node;
+      node = node->_next;
+   }
+
+ 	mergesort_rec(fcmp, &nodes[0], &buffer[0], n);
+
+   DL_Node<Dtype>* prev = RT;
+   for (int i = 0; i < n; i++)
+   {
+      prev->_next = nodes[i];
+      nodes[i]->_prev = prev;
+      prev = nodes[i];
+   }
+   prev->_next = RT;
+   RT->_prev = prev;
 }
 
 
+/*!
+   sort all items in the list on two keys, which the key function works out once for each item.
+
+\note
+   The items are sorted going up on the first key, then going up on the second key,
+   and items with the same keys stay in the order they were.
+   That is the same order mergesort gives with a compare function which compares the same keys,
+   but the compare function doesn't have to look at the items again for each comparison.
+   To sort going down on a key, the key function can return minus the value.
+
+\par example
+   sort a list of links on the X of their begin nodes going up, and then on Y going down
+\code
+void linkXYkeys(KBoolLink* a, B_INT& key1, B_INT& key2)
+{
+   key1 = a->GetBeginNode()->GetX();
+   key2 = -a->GetBeginNode()->GetY();
+}
+
+a_listiter->keysort(linkXYkeys);
+\endcode
+*/
 template <class Dtype>
-void DL_Iter<Dtype>::mergesort_rec(int (*fcmp)(Dtype,Dtype), DL_Node<Dtype> *RT1, int n1)
+void DL_Iter<Dtype>::keysort(void (*fkey) (Dtype, B_INT&, B_INT&))
+{
+	if (_current==0)
+		Error("keysort()",NO_LIST);
+
+   int n = NB;
+   if (n < 2)
+      return;
+
+   std::vector< DL_SortKey<Dtype> > keys(n);
+   DL_Node<Dtype>* node = RT->_next;
+   for (int i = 0; i < n; i++)
+   {
+      fkey(node->_item, keys[i]._key1, keys[i]._key2);
+      keys[i]._node = node;
+      node = node->_next;
+   }
+
+   std::stable_sort(keys.begin(), keys.end());
+
+   DL_Node<Dtype>* prev = RT;
+   for (int i = 0; i < n; i++)
+   {
+      prev->_next = keys[i]._node;
+      keys[i]._node->_prev = prev;
+      prev = keys[i]._node;
+   }
+   prev->_next = RT;
+   RT->_prev = prev;
+}
+
+
+template <class Dtype>
+void DL_Iter<Dtype>::mergesort_rec(int (*fcmp)(Dtype,Dtype), DL_Node<Dtype> **nodes, DL_Node<Dtype> **buffer, int n1)
 {
    if (n1 > 1)  //one element left then stop
    {
-		DL_Node<Dtype>       RT2;
 	   int n2;
 
-      RT2._prev=RT1->_prev;
-      RT2._next=RT1->_next;
-      // goto middle
+      // the first half is the shorter one
       n2=n1;n1>>=1;n2-=n1;
-      for (int i=0; i <n1;i++)
-         RT2._next=RT2._next->_next;
-
-      //RT2 is at half
-      RT1->_prev->_next=&RT2;
-      RT2._prev=RT1->_prev;
-      RT1->_prev=RT2._next->_prev;
-      RT2._next->_prev->_next=RT1;
-
-     	mergesort_rec(fcmp,RT1,n1);
-     	mergesort_rec(fcmp,&RT2,n2);
-     	mergetwo(fcmp,RT1,&RT2);
+
+     	mergesort_rec(fcmp,nodes,buffer,n1);
+     	mergesort_rec(fcmp,nodes+n1,buffer,n2);
+     	mergetwo(fcmp,nodes,n1,n2,buffer);
    }
 }
 
 template <class Dtype>
-void DL_Iter<Dtype>::mergetwo(int (*fcmp)(Dtype,Dtype), DL_Node<Dtype> *RT1,DL_Node<Dtype> *RT2)
+void DL_Iter<Dtype>::mergetwo(int (*fcmp)(Dtype,Dtype), DL_Node<Dtype> **nodes, int n1, int n2, DL_Node<Dtype> **buffer)
 {
-	DL_Node<Dtype>       *c,*a,*b;
-   a=RT1->_next;b=RT2->_next;
-   c=RT1;
-   do
+   // merge nodes[0..n1) with nodes[n1..n1+n2), taking from the first when the compare function doesn't return -1
+   int a = 0, b = n1, c = 0, end = n1 + n2;
+   for (int i = 0; i < n1; i++)
+      buffer[i] = nodes[i];
+
+   while (a < n1 && b < end)
    {
-      if (fcmp(a->_item , b->_item) > -1)
-      { c->_next=a;a->_prev=c;c=a;a=a->_next;}
+      if (fcmp(buffer[a]->_item , nodes[b]->_item) > -1)
+         nodes[c++] = buffer[a++];
       else
-      { c->_next=b;b->_prev=c;c=b;b=b->_next;}
-      if (a == RT1)
-      { 	c->_next=
-          b;b->_prev=c; //connect list b to the list made sofar
-         RT1->_prev=RT2->_prev;
-         RT1->_prev->_next=RT1;
-      	break;
-      }
-      if (b == RT2)
-      { 	c->_next=a;a->_prev=c; //connect list a to the list made sofar
-      	break;
-      }
+         nodes[c++] = nodes[b++];
    }
-   while (true);
+   while (a < n1)
+      nodes[c++] = buffer[a++];
 }
 
 
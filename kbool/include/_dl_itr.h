@@ -22,6 +22,8 @@
 #endif
 
 #include <stdlib.h>
+#include <vector>
+#include <algorithm>
 #include "kbool/include/booleng.h"
 
 #ifndef _STATUS_ENUM
@@ -75,6 +77,8 @@ template <class Dtype>  class DL_Node
 		   //!Destructor
          ~DL_Node();
 
+         KBOOL_POOLED_NEW
+
       //!Public members
    	public:
          //!data in node
@@ -87,6 +91,23 @@ template <class Dtype>  class DL_Node
          DL_Node* _prev;
 };
 
+//!   Template class DL_SortKey
+//!   the keys of a list node, for DL_Iter::keysort
+template <class Dtype>  class DL_SortKey
+{
+      public:
+         B_INT _key1;
+         B_INT _key2;
+         DL_Node<Dtype>* _node;
+
+         bool operator<(const DL_SortKey& other) const
+         {
+            if (_key1 != other._key1)
+               return _key1 < other._key1;
+            return _key2 < other._key2;
+         }
+};
+
 //!Template class DL_List
 template <class Dtype> class DL_List
 {
@@ -299,6 +320,9 @@ class DL_Iter
 		//!sort list with mergesort
 		void mergesort(int (*fcmp) (Dtype, Dtype));
 
+		//!sort list on two keys per item, worked out once for each item
+		void keysort(void (*fkey) (Dtype, B_INT&, B_INT&));
+
 		//!sort list with cocktailsort
         /*! 
                 \return number of swaps done.
@@ -308,10 +332,10 @@ class DL_Iter
 	protected:
 
 		//!sort list with mergesort
-		void mergesort_rec(int (*fcmp)(Dtype,Dtype), DL_Node<Dtype> *RT1,int n);
+		void mergesort_rec(int (*fcmp)(Dtype,Dtype), DL_Node<Dtype> **nodes, DL_Node<Dtype> **buffer, int n);
 
 		//!sort list with mergesort
-		void mergetwo(int (*fcmp)(Dtype,Dtype), DL_Node<Dtype> *RT1,DL_Node<Dtype> *RT2);
+		void mergetwo(int (*fcmp)(Dtype,Dtype), DL_Node<Dtype> **nodes, int n1, int n2, DL_Node<Dtype> **buffer);
 
 		//!set the iterator position to next object in the list ( can be the root also).
 		void next();
@@ -184,6 +184,12 @@ void TDLI<Type>::mergesort(int (*f)(Type* a,Type* b))
    DL_Iter<void*>::mergesort( (int (*)(void*,void*)) f);
 }
 
+template<class Type>
+void TDLI<Type>::keysort(void (*f)(Type* a,B_INT& key1,B_INT& key2))
+{
+   DL_Iter<void*>::keysort( (void (*)(void*,B_INT&,B_INT&)) f);
+}
+
 template<class Type>
 int TDLI<Type>::cocktailsort(int (*f)(Type* a,Type* b), bool (*f2)(Type* c,Type* d))
 {
@@ -116,6 +116,8 @@ template<class Type> class TDLI : public DL_Iter<void*>
 
       //! \sa DL_Iter::mergesort
 		void    mergesort             (int (*f)(Type* a,Type* b));
+      //! \sa DL_Iter::keysort
+		void    keysort               (void (*f)(Type* a,B_INT& key1,B_INT& key2));
       //! \sa DL_Iter::cocktailsort
 		int  cocktailsort( int (*) (Type* a,Type* b), bool (*) (Type* c,Type* d) = NULL);
 
@@ -117,6 +117,28 @@ B_INT bmax(B_INT value1, B_INT value2);
 
 #include <string.h>
 
+//! memory for the small objects the engine makes and deletes by the million ( nodes, links, records and list nodes ).
+/*!
+    Blocks of the same size are handed out from big chunks, and reused when deleted,
+    so the objects are close together in memory and don't each need a trip to the heap.
+    Each thread has its own chunks, which are freed when the thread ends,
+    so an object must be deleted by the thread which made it, as a Bool_Engine is.
+    Sizes bigger than a block go to the normal heap.
+*/
+A2DKBOOLDLLEXP void* KBoolPoolAlloc(size_t size);
+A2DKBOOLDLLEXP void KBoolPoolFree(void* block, size_t size);
+
+//! bytes handed out by KBoolPoolAlloc and not freed yet, on the calling thread.
+A2DKBOOLDLLEXP size_t KBoolPoolBytesInUse();
+//! the most bytes in use on the calling thread, since KBoolPoolSetPeakBytes.
+A2DKBOOLDLLEXP size_t KBoolPoolPeakBytes();
+A2DKBOOLDLLEXP void KBoolPoolSetPeakBytes(size_t bytes);
+
+//! put in a class declaration to make its objects in the pool.
+#define KBOOL_POOLED_NEW \
+   static void* operator new(size_t size) { return KBoolPoolAlloc(size); } \
+   static void operator delete(void* block, size_t size) { KBoolPoolFree(block, size); }
+
 //! errors in the boolean algorithm will be thrown using this class
 class A2DKBOOLDLLEXP Bool_Engine_Error
 {
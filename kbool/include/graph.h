@@ -29,6 +29,8 @@ Last Update	03-04-1996
 #include "kbool/include/line.h"
 #include "kbool/include/scanbeam.h"
 
+#include <vector>
+
 class Node;
 
 class GraphList;
@@ -50,7 +52,13 @@ class A2DKBOOLDLLEXP Graph
       bool		 GetBin() 							{ return _bin; };
       void		 SetBin(bool b) 					{ _bin = b; };
 
-		void 		 Prepare( int intersectionruns );
+      //! calculates crossings and sets the flags for the operations
+      /*!
+          \param intersectionruns how many times crossings are calculated, until none are found.
+          \param oriented when boundaries go clockwise and holes anticlockwise, the winding
+          of the links is known from their direction, and no scan is needed to find it.
+      */
+		void 		 Prepare( int intersectionruns, bool oriented = false );
 		void      RoundInt(B_INT grid);
 		void 		 Rotate(bool plus90);
 
@@ -111,7 +119,10 @@ class A2DKBOOLDLLEXP Graph
 		int			GetNumberOfLinks();
 
 		void        Boolean(BOOL_OP operation,GraphList* Result);
-		void        Correction(GraphList* Result,double factor);
+		void        Correction(GraphList* Result,double factor,bool rings = false);
+		bool        CreateOffsetContours(GraphList* list,double factor);
+		bool        OffsetContour(double factor, double aber, double roundfactor, std::vector<B_INT>& px, std::vector<B_INT>& py, std::vector<int>& pud);
+		static void AddOffsetPoint(std::vector<B_INT>& px, std::vector<B_INT>& py, std::vector<int>& pud, B_INT x, B_INT y, int user_data);
 		void        MakeRing(GraphList* Result,double factor);
 		void        CreateRing(GraphList *ring,double factor);
 		void        CreateRing_fast(GraphList *ring,double factor);
@@ -180,6 +191,15 @@ class A2DKBOOLDLLEXP Graph
       //! equal nodes in position are merged into one.
 		int	Merge_NodeToNode(B_INT Marge);
 
+      //! nodes closer then Marge to a steep link, measured along X, are made part of the link.
+      /*!
+          The scanbeam finds nodes close to a link measured along Y, which misses them near
+          (almost) vertical links. Instead of rotating the graph and scanning again,
+          only the steep links are tested here, in one sweep over the nodes in X order.
+          \param Marge nodes and lines closer to eachother then this, are merged.
+      */
+		int	Merge_NodeToSteepLink(B_INT Marge);
+
       //! basic scan algorithm with a sweeping beam are line.
       /*!
           \param scantype a different face in the algorithm.
@@ -53,6 +53,8 @@ class A2DKBOOLDLLEXP KBoolLink
 		//! destructors
 		~KBoolLink();
 
+		KBOOL_POOLED_NEW
+
 
       //! Merges the other node with argument
 		void MergeNodes(Node* const);      				
@@ -44,6 +44,8 @@ class A2DKBOOLDLLEXP Node : public LPoint
 		Node& operator=(const Node &other_node);
 		~Node();
 
+		KBOOL_POOLED_NEW
+
 		//public member functions
 		void AddLink(KBoolLink*);
 		DL_List<void*>* GetLinklist();
@@ -25,7 +25,6 @@ enum BEAM_TYPE { NORMAL,FLAT};
 
 enum DIRECTION  {GO_LEFT,GO_RIGHT};
 
-//extern void DeleteRecordPool();
 class A2DKBOOLDLLEXP Bool_Engine;
 
 class A2DKBOOLDLLEXP Record
@@ -33,15 +32,11 @@ class A2DKBOOLDLLEXP Record
         protected:
                                         Bool_Engine* _GC;
 	public:
-//					void deletepool();
-
 					Record(KBoolLink* link,Bool_Engine* GC);
 
 					~Record();
 
-//					void* operator new(size_t size);
-
-//					void operator delete(void* recordptr);
+					KBOOL_POOLED_NEW
 
 					void SetNewLink(KBoolLink* link);
 
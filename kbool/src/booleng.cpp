@@ -14,6 +14,8 @@
 
 #include <math.h>
 #include <time.h>
+#include <new>
+#include <vector>
 
 #include "kbool/include/booleng.h"
 #include "kbool/include/link.h"
@@ -38,6 +40,121 @@ B_INT babs(B_INT a)
    return a;
 }
 
+//! blocks are a multiple of this size
+#define POOL_GRAIN 16
+//! number of block sizes, so the biggest block is POOL_SIZES * POOL_GRAIN bytes
+#define POOL_SIZES 8
+//! size of the chunks the blocks are cut from
+#define POOL_CHUNK 65536
+
+struct PoolBlock
+{
+   PoolBlock* _next;
+};
+
+//! a thread's chunks, and a list of free blocks for each block size
+class Pool
+{
+   public:
+      Pool()
+      {
+         for (int i = 0; i < POOL_SIZES; i++)
+            _free[i] = NULL;
+         _unused = NULL;
+         _unused_size = 0;
+      }
+
+      ~Pool()
+      {
+         for (unsigned int i = 0; i < _chunks.size(); i++)
+            free(_chunks[i]);
+      }
+
+      void* Alloc(int index)
+      {
+         PoolBlock* block = _free[index];
+         if (block)
+         {
+            _free[index] = block->_next;
+            return block;
+         }
+
+         // cut a new block from the current chunk, the end of the chunk is wasted if it's too small
+         size_t block_size = (index + 1) * POOL_GRAIN;
+         if (_unused_size < block_size)
+         {
+            _unused = (char*) malloc(POOL_CHUNK);
+            if (!_unused)
+               throw std::bad_alloc();
+            _chunks.push_back(_unused);
+            _unused_size = POOL_CHUNK;
+         }
+         void* result = _unused;
+         _unused += block_size;
+         _unused_size -= block_size;
+         return result;
+      }
+
+      void Free(void* p, int index)
+      {
+         PoolBlock* block = (PoolBlock*) p;
+         block->_next = _free[index];
+         _free[index] = block;
+      }
+
+   private:
+      PoolBlock* _free[POOL_SIZES];
+      std::vector<char*> _chunks;
+      char* _unused;
+      size_t _unused_size;
+};
+
+static thread_local Pool pool;
+static thread_local size_t pool_bytes_in_use = 0;
+static thread_local size_t pool_peak_bytes = 0;
+
+void* KBoolPoolAlloc(size_t size)
+{
+   if (size == 0)
+      size = 1;
+   pool_bytes_in_use += size;
+   if (pool_bytes_in_use > pool_peak_bytes)
+      pool_peak_bytes = pool_bytes_in_use;
+   if (size > POOL_SIZES * POOL_GRAIN)
+      return ::operator new(size);
+   return pool.Alloc((int)((size - 1) / POOL_GRAIN));
+}
+
+void KBoolPoolFree(void* block, size_t size)
+{
+   if (!block)
+      return;
+   if (size == 0)
+      size = 1;
+   pool_bytes_in_use -= size;
+   if (size > POOL_SIZES * POOL_GRAIN)
+   {
+      ::operator delete(block);
+      return;
+   }
+   pool.Free(block, (int)((size - 1) / POOL_GRAIN));
+}
+
+size_t KBoolPoolBytesInUse()
+{
+   return pool_bytes_in_use;
+}
+
+size_t KBoolPoolPeakBytes()
+{
+   return pool_peak_bytes;
+}
+
+void KBoolPoolSetPeakBytes(size_t bytes)
+{
+   pool_peak_bytes = bytes;
+}
+
 //-------------------------------------------------------------------/
 //----------------- Bool_Engine_Error -------------------------------/
 //-------------------------------------------------------------------/
@@ -17,6 +17,8 @@
 
 #include <math.h>
 #include <assert.h>
+#include <vector>
+#include <algorithm>
 
 #include "kbool/include/booleng.h"
 #include "kbool/include/graph.h"
@@ -29,6 +31,11 @@ int linkYXsorter(KBoolLink *, KBoolLink *);
 int linkLsorter(KBoolLink *, KBoolLink *);
 int linkYXtopsorter(KBoolLink *a, KBoolLink *b);
 int linkGraphNumsorter(KBoolLink *_l1, KBoolLink* _l2);
+void linkXYkeys(KBoolLink *, B_INT&, B_INT&);
+void linkYXkeys(KBoolLink *, B_INT&, B_INT&);
+void linkLkeys(KBoolLink *, B_INT&, B_INT&);
+void linkYXtopkeys(KBoolLink *, B_INT&, B_INT&);
+void linkGraphNumkeys(KBoolLink *, B_INT&, B_INT&);
 
 // constructor, initialize with one link
 // usage: Graph *a_graph = new Graph(a_link);
@@ -98,7 +105,7 @@ KBoolLink*	Graph::GetFirstLink()
 };
 
 
-void Graph::Prepare( int intersectionruns )
+void Graph::Prepare( int intersectionruns, bool oriented )
 {
 	_GC->SetState("Intersection");
 
@@ -121,7 +128,19 @@ void Graph::Prepare( int intersectionruns )
 
    bool dummy = false;
 
-   if (_GC->GetWindingRule())
+   if (oriented)
+   {
+      //outlines go clockwise and holes anticlockwise, so a link going right (or down when vertical)
+      //has the inside below it, no need to find that out with a scan
+   	TDLI<KBoolLink> _LI=TDLI<KBoolLink>(_linklist);
+      for (_LI.tohead(); !_LI.hitroot(); _LI++)
+      {
+         KBoolLink* link = _LI.item();
+         B_INT dx = link->GetEndNode()->GetX() - link->GetBeginNode()->GetX();
+         link->SetInc( dx > 0 || ( dx == 0 && link->GetEndNode()->GetY() < link->GetBeginNode()->GetY() ) );
+      }
+   }
+   else if (_GC->GetWindingRule())
 	   ScanGraph2( INOUT, dummy );
 
    ScanGraph2( GENLR, dummy );
@@ -182,7 +201,7 @@ void Graph::Rotate(bool plus90)
       neg=1;
 
    TDLI<KBoolLink> _LI=TDLI<KBoolLink>(_linklist);
-	_LI.mergesort(linkXYsorter);
+	_LI.keysort(linkXYkeys);
 
 	_LI.tohead();
 	while (!_LI.hitroot())
@@ -655,7 +674,7 @@ void Graph::Extract_Simples(BOOL_OP operation, bool detecthole, bool& foundholes
 	Node *begin;
    int graphnumber=1;
 
-	_LI.mergesort(linkYXtopsorter);
+	_LI.keysort(linkYXtopkeys);
    _LI.tohead();
 	while (true)
 	{
@@ -690,7 +709,7 @@ void Graph::Split(GraphList* partlist)
   int graphnumber=0;
 
   //sort the graph on graphnumber
-  _LI.mergesort(linkGraphNumsorter);
+  _LI.keysort(linkGraphNumkeys);
 
   _LI.tohead();
   while (!_LI.hitroot())
@@ -1087,7 +1106,7 @@ bool Graph::Smoothen( B_INT Marge )
 
 	kill=false;
 	todo = _LI.count();
-	_LI.mergesort(linkLsorter);
+	_LI.keysort(linkLkeys);
 	_LI.tohead();
 
 	while (todo>0)
@@ -1099,7 +1118,7 @@ bool Graph::Smoothen( B_INT Marge )
 			graph_is_modified = true;
 			kill = false;
 			//mergesort(linkLsorter);
-			_LI.mergesort(linkLsorter);
+			_LI.keysort(linkLkeys);
 			_LI.tohead();
 			todo = _LI.count();
 			if (todo<3)		// A polygon, at least, has 3 sides
@@ -1341,14 +1360,8 @@ bool Graph::CalculateCrossings(B_INT Marge)
 
    found = ScanGraph2(NODELINK, dummy) != 0 || found;
 
-	_GC->SetState("Rotate -90");
-	Rotate(false);
-
-	_GC->SetState("Node to KBoolLink -90");
-   found = ScanGraph2(NODELINK, dummy) != 0 || found;
-
-	_GC->SetState("Rotate +90");
-	Rotate(true);
+	_GC->SetState("Node to steep KBoolLink");
+   found = Merge_NodeToSteepLink(Marge) != 0 || found;
 
 	// LINK <==> LINK
 	_GC->SetState("intersect");
@@ -1359,7 +1372,7 @@ bool Graph::CalculateCrossings(B_INT Marge)
    if (!checksort())
    { {
 	   TDLI<KBoolLink> _LI=TDLI<KBoolLink>(_linklist);
-		_LI.mergesort(linkXYsorter);
+		_LI.keysort(linkXYkeys);
      }
 	  writeintersections();
 	  writegraph(true);
@@ -1395,7 +1408,7 @@ int Graph::Merge_NodeToNode(B_INT Marge)
       _LI.foreach_mf(&KBoolLink::UnMark);
 
       //sort links on x value of beginnode
-      _LI.mergesort(linkXYsorter);
+      _LI.keysort(linkXYkeys);
 
       //extra iterator voor doorlopen links in graph
       {
@@ -1456,13 +1469,129 @@ int Graph::Merge_NodeToNode(B_INT Marge)
 }
 
 
+// a link which is at least half as high as it is wide, and the X range in which nodes can be close to it
+class SteepLink
+{
+   public:
+      B_INT _xmin;
+      B_INT _xmax;
+      KBoolLine* _line;
+
+      bool operator<(const SteepLink& other) const { return _xmin < other._xmin; }
+};
+
+// The NODELINK scan finds the nodes within Marge of a link in Y, at the X of the node.
+// For links which are not steep, that also catches the nodes within Marge in X.
+// For steep links the X distance is tested here, the same way the scan would do it
+// with the graph rotated by -90 degrees.
+int Graph::Merge_NodeToSteepLink(B_INT Marge)
+{
+   int merges = 0;
+   TDLI<KBoolLink> _LI=TDLI<KBoolLink>(_linklist);
+
+   std::vector<SteepLink> steep;
+   for(_LI.tohead(); !_LI.hitroot(); _LI++)
+   {
+      KBoolLink* link = _LI.item();
+      B_INT dx = babs(link->GetEndNode()->GetX() - link->GetBeginNode()->GetX());
+      B_INT dy = babs(link->GetEndNode()->GetY() - link->GetBeginNode()->GetY());
+      if (dy == 0 || 2 * dy < dx)
+         continue;
+
+      SteepLink s;
+      s._xmin = bmin(link->GetBeginNode()->GetX(), link->GetEndNode()->GetX()) - Marge;
+      s._xmax = bmax(link->GetBeginNode()->GetX(), link->GetEndNode()->GetX()) + Marge;
+      s._line = new KBoolLine(link, _GC);
+      steep.push_back(s);
+   }
+
+   if (steep.empty())
+      return 0;
+
+   std::stable_sort(steep.begin(), steep.end());
+
+   //sort links on x and y value of beginnode, to visit the nodes in X order
+   _LI.keysort(linkXYkeys);
+
+   std::vector<SteepLink*> active;
+   unsigned int next_steep = 0;
+   Node* last = NULL;
+   for(_LI.tohead(); !_LI.hitroot(); _LI++)
+   {
+      Node* node = _LI.item()->GetBeginNode();
+      if (node == last)
+         continue;
+      last = node;
+
+      B_INT x = node->GetX();
+      B_INT y = node->GetY();
+
+      while (next_steep < steep.size() && steep[next_steep]._xmin <= x)
+         active.push_back(&steep[next_steep++]);
+
+      unsigned int i = 0;
+      while (i < active.size())
+      {
+         if (active[i]->_xmax < x)
+         {
+            active[i] = active.back();
+            active.pop_back();
+            continue;
+         }
+
+         KBoolLine* line = active[i]->_line;
+         Node* bp = line->GetLink()->GetBeginNode();
+         Node* ep = line->GetLink()->GetEndNode();
+         i++;
+
+         if (node == bp || node == ep)
+            continue;
+         if (y < bmin(bp->GetY(), ep->GetY()) || y > bmax(bp->GetY(), ep->GetY()))
+            continue;
+
+         // the X of the link at the Y of the node, as Record::Calc_Ysp works it out in the rotated graph
+         B_INT xsp;
+         if (ep->GetY() == y)
+            xsp = ep->GetX();
+         else if (bp->GetY() == y)
+            xsp = bp->GetX();
+         else if (bp->GetX() == ep->GetX())
+            xsp = bp->GetX();
+         else
+         {
+            double AA = (double) (bp->GetX() - ep->GetX());
+            double BB = (double) (bp->GetY() - ep->GetY());
+            double length = sqrt(AA*AA + BB*BB);
+            AA = AA / length;
+            BB = BB / length;
+            double CC = -((AA * bp->GetY()) + (-bp->GetX() * BB));
+            xsp = -(B_INT) ((-(AA * y + CC) / BB)+0.5);
+         }
+
+         if (babs(xsp - x) <= Marge)
+         {
+            line->AddCrossing(node);
+            merges++;
+         }
+      }
+   }
+
+   for (unsigned int i = 0; i < steep.size(); i++)
+   {
+      steep[i]._line->ProcessCrossings(&_LI);
+      delete steep[i]._line;
+   }
+
+   return merges;
+}
+
 int Graph::ScanGraph2(SCANTYPE scantype, bool& holes )
 {
    TDLI<KBoolLink> _LI=TDLI<KBoolLink>(_linklist);
    int found=0;
 
 	//sort links on x and y value of beginnode
-	_LI.mergesort(linkXYsorter);
+	_LI.keysort(linkXYkeys);
 
 	writegraph( false );
 
@@ -1640,6 +1769,48 @@ int linkGraphNumsorter(KBoolLink *_l1, KBoolLink* _l2)
 	return(0);
 }
 
+// The keys for sorting the links with keysort, in the same order as the sorters above
+
+// X of the beginnode going up, then Y going down, as linkXYsorter
+void linkXYkeys(KBoolLink *a, B_INT& key1, B_INT& key2)
+{
+	key1 = a->GetBeginNode()->GetX();
+	key2 = -a->GetBeginNode()->GetY();
+}
+
+// Y of the beginnode going down, then X going up, as linkYXsorter
+void linkYXkeys(KBoolLink *a, B_INT& key1, B_INT& key2)
+{
+	key1 = -a->GetBeginNode()->GetY();
+	key2 = a->GetBeginNode()->GetX();
+}
+
+// shortest to longest, as linkLsorter
+void linkLkeys(KBoolLink *a, B_INT& key1, B_INT& key2)
+{
+	B_INT dx,dy;
+	dx = (a->GetEndNode()->GetX() - a->GetBeginNode()->GetX());
+	dx*=dx;
+	dy = (a->GetEndNode()->GetY() - a->GetBeginNode()->GetY());
+	dy*=dy;
+	key1 = dx + dy;
+	key2 = 0;
+}
+
+// top node going down, then the most left going down, as linkYXtopsorter
+void linkYXtopkeys(KBoolLink *a, B_INT& key1, B_INT& key2)
+{
+	key1 = -bmax(a->GetBeginNode()->GetY(),a->GetEndNode()->GetY());
+	key2 = -bmin(a->GetBeginNode()->GetX(),a->GetEndNode()->GetX());
+}
+
+// graph number going up, as linkGraphNumsorter
+void linkGraphNumkeys(KBoolLink *a, B_INT& key1, B_INT& key2)
+{
+	key1 = a->GetGraphNum();
+	key2 = 0;
+}
+
 // Perform an operation on the graph
 void Graph::Boolean(BOOL_OP operation,GraphList* Result)
 {
@@ -1717,13 +1888,12 @@ void Graph::Boolean(BOOL_OP operation,GraphList* Result)
    Split(Result);
 }
 
-// Perform an correction on the graph
-void Graph::Correction( GraphList* Result, double factor )
+void Graph::Correction( GraphList* Result, double factor, bool rings )
 {
 	// At this moment we have one graph
 	// step one, split it up in single graphs, and mark the holes
-	// step two, make one graph again and link the holes
-	// step three, split up again and dump the result in Result
+	// step two, move their outlines by factor, or make rings around them
+	// step three, merge those and dump the result in Result
 	_GC->SetState("Extract simple graphs");
 
 	//extract the (MERGE or OR) result from the graph
@@ -1774,90 +1944,104 @@ void Graph::Correction( GraphList* Result, double factor )
 
 	//Result contains the separate boundaries and holes
 
-   //ring creation should never be alternate rule, since it overlaps.
-   //So temprarely modify it.
-   bool rule = _GC->GetWindingRule();
-   _GC->SetWindingRule( true );
-
-	_GC->SetState("Create rings");
-	//first create a ring around all simple graphs
+   //boundaries go clockwise and holes anticlockwise, so moving every outline to the left of its links
+   //moves a boundary to its outside and a hole to its inside, and the moved outlines are all that is needed.
+   //Only when an outline is not a closed chain, or the moved outlines can't be merged, rings are made
+   //around them, which are added to or subtracted from the original.
+	_GC->SetState("Create offset contours");
+   bool oriented = !rings && CreateOffsetContours( Result, factor );
+   if ( oriented )
+   {
+      SetNumber(1);
+      SetGroup(GROUP_A);
+   }
+   else
    {
-     	TDLI<Graph> IResult=TDLI<Graph>(Result);
-      GraphList *_ring = new GraphList(_GC);
+      //ring creation should never be alternate rule, since it overlaps.
+      //So temprarely modify it.
+      bool rule = _GC->GetWindingRule();
+      _GC->SetWindingRule( true );
+
+   	_GC->SetState("Create rings");
+   	//first create a ring around all simple graphs
       {
-         //put into one graphlist
-         IResult.tohead();
-         int i;
-         int n=IResult.count();
-         for (i=0;i<n;i++)
+        	TDLI<Graph> IResult=TDLI<Graph>(Result);
+         GraphList *_ring = new GraphList(_GC);
          {
-           {
-				  IResult.item()->MakeClockWise();
-              IResult.item()->CreateRing_fast(_ring,fabs(factor));
-      //			  IResult.item()->CreateRing(_ring,fabs(factor));
-           }
-           delete(IResult.item());
-           IResult.remove();
-
-            //move ring graphlist to result
-            while (!_ring->empty())
+            //put into one graphlist
+            IResult.tohead();
+            int i;
+            int n=IResult.count();
+            for (i=0;i<n;i++)
             {
-               //add to end
-					((Graph*)_ring->headitem())->MakeClockWise();
-               IResult.insend((Graph*)_ring->headitem());
-               _ring->removehead();
+              {
+   				  IResult.item()->MakeClockWise();
+                 IResult.item()->CreateRing_fast(_ring,fabs(factor));
+         //			  IResult.item()->CreateRing(_ring,fabs(factor));
+              }
+              delete(IResult.item());
+              IResult.remove();
+
+               //move ring graphlist to result
+               while (!_ring->empty())
+               {
+                  //add to end
+   					((Graph*)_ring->headitem())->MakeClockWise();
+                  IResult.insend((Graph*)_ring->headitem());
+                  _ring->removehead();
+               }
             }
          }
-      }
-      delete _ring;
+         delete _ring;
 
-      //IResult contains all rings
-      //prepare the graphs for extracting the links of a certain operation
-      //set original graphlist to groupA and ring to groupB
-      int i=2;
-      IResult.tohead();
-      while (!IResult.hitroot())
-      {
-        IResult.item()->Reset_flags();
-        IResult.item()->SetGroup(GROUP_B);
-        IResult.item()->SetNumber(i);
-        i++;
-        IResult++;
+         //IResult contains all rings
+         //prepare the graphs for extracting the links of a certain operation
+         //set original graphlist to groupA and ring to groupB
+         int i=2;
+         IResult.tohead();
+         while (!IResult.hitroot())
+         {
+           IResult.item()->Reset_flags();
+           IResult.item()->SetGroup(GROUP_B);
+           IResult.item()->SetNumber(i);
+           i++;
+           IResult++;
+         }
       }
-   }
 
-   //a ring shape can overlap itself, for alternate filling this is problem. 
-   //doing a merge in winding rule makes this oke, since overlap is removed by it.
-   if ( !rule ) //alternate rule? 
-   {
-      Prepare(1);
-      Boolean(BOOL_OR,Result);
-
-     	TDLI<Graph> IResult=TDLI<Graph>(Result);
-      //IResult contains all rings
-      //prepare the graphs for extracting the links of a certain operation
-      //set original graphlist to groupA and ring to groupB
-      int i=2;
-      IResult.tohead();
-      while (!IResult.hitroot())
+      //a ring shape can overlap itself, for alternate filling this is problem. 
+      //doing a merge in winding rule makes this oke, since overlap is removed by it.
+      if ( !rule ) //alternate rule? 
       {
-        IResult.item()->Reset_flags();
-        IResult.item()->SetGroup(GROUP_B);
-        IResult.item()->SetNumber(i);
-        i++;
-        IResult++;
+         Prepare(1);
+         Boolean(BOOL_OR,Result);
+
+        	TDLI<Graph> IResult=TDLI<Graph>(Result);
+         //IResult contains all rings
+         //prepare the graphs for extracting the links of a certain operation
+         //set original graphlist to groupA and ring to groupB
+         int i=2;
+         IResult.tohead();
+         while (!IResult.hitroot())
+         {
+           IResult.item()->Reset_flags();
+           IResult.item()->SetGroup(GROUP_B);
+           IResult.item()->SetNumber(i);
+           i++;
+           IResult++;
+         }
       }
-   }
 
-   //restore filling rule
-   _GC->SetWindingRule( rule );
+      //restore filling rule
+      _GC->SetWindingRule( rule );
 
-	TakeOver(original);
-   Reset_flags();
-   SetNumber(1);
-   SetGroup(GROUP_A);
-	Result->MakeOneGraph(this); // adds all graph its links to original
-										  // Result will be empty afterwords
+   	TakeOver(original);
+      Reset_flags();
+      SetNumber(1);
+      SetGroup(GROUP_A);
+   	Result->MakeOneGraph(this); // adds all graph its links to original
+   										  // Result will be empty afterwords
+   }
 
 
 	//merge ring with original shapes for positive correction else subtract ring
@@ -1877,15 +2061,53 @@ void Graph::Correction( GraphList* Result, double factor )
 		   _GC->SetInternalMarge(1);
 	}
 
+   if ( oriented )
+   {
+      //the moved outlines overlap themselves and eachother, the result is where their winding is positive
+      bool rule = _GC->GetWindingRule();
+      try
+      {
+         _GC->SetWindingRule( true );
+         Prepare(1, true);
+         _GC->SetWindingRule( rule );
 
-	Prepare(1);
+	      _GC->SetState("Merge offset contours");
+         Boolean(BOOL_OR,Result);
+      }
+      catch (Bool_Engine_Error& error)
+      {
+         //many moved outlines crossing near one point, as when an outline nearly vanishes, can be too much
+         //for the merge, so throw away what was done and start again from the original with rings
+         _GC->info(error.GetErrorMessage(), "offset contours not merged, making rings");
+         _GC->SetWindingRule( rule );
+         _GC->SetMarge( Backup_Marge );
 
-	_GC->SetState("Add/Substract rings");
+         {
+           	TDLI<Graph> IResult=TDLI<Graph>(Result);
+            IResult.delete_all();
+         }
+         {
+            TDLI<KBoolLink> _LI=TDLI<KBoolLink>(_linklist);
+            _LI.delete_all();
+         }
 
-	if (factor > 0)
-		Boolean(BOOL_OR,Result);
-	else
-		Boolean(BOOL_A_SUB_B,Result);
+         TakeOver(original);
+         delete original;
+         Correction(Result, factor, true);
+         return;
+      }
+   }
+   else
+   {
+	   Prepare(1);
+
+	   _GC->SetState("Add/Substract rings");
+
+	   if (factor > 0)
+		   Boolean(BOOL_OR,Result);
+	   else
+		   Boolean(BOOL_A_SUB_B,Result);
+   }
 
 	_GC->SetMarge( Backup_Marge);
 
@@ -1893,6 +2115,211 @@ void Graph::Correction( GraphList* Result, double factor )
    delete original;
 }
 
+//move the outline of each simple graph in the list by factor to the left of its links, and add them to this graph.
+//If one of them is not a closed chain of links, nothing is added and the list is left as it is.
+bool Graph::CreateOffsetContours( GraphList* list, double factor )
+{
+   std::vector<Graph*> graphs;
+   {
+     	TDLI<Graph> _LI=TDLI<Graph>(list);
+      for (_LI.tohead(); !_LI.hitroot(); _LI++)
+         graphs.push_back(_LI.item());
+   }
+
+   int n = (int) graphs.size();
+   double aber = _GC->GetInternalCorrectionAber();
+   double roundfactor = _GC->GetRoundfactor();
+
+   //no nodes are made while the points are worked out, so the graphs can be done in parallel
+   std::vector< std::vector<B_INT> > px(n);
+   std::vector< std::vector<B_INT> > py(n);
+   std::vector< std::vector<int> > pud(n);
+   std::vector<char> moved(n, 0);
+
+#pragma omp parallel for schedule(dynamic)
+   for (int i = 0; i < n; i++)
+   {
+      try
+      {
+         moved[i] = graphs[i]->OffsetContour( factor, aber, roundfactor, px[i], py[i], pud[i] );
+      }
+      catch(...)
+      {
+         moved[i] = 0; // an exception mustn't leave the parallel loop, make rings instead
+      }
+   }
+
+   for (int i = 0; i < n; i++)
+      if (!moved[i])
+         return false;
+
+   for (int i = 0; i < n; i++)
+   {
+      int m = (int) px[i].size();
+      if (m < 3)
+         continue;
+
+      Node* first = new Node(px[i][0], py[i][0], _GC);
+      Node* last = first;
+      for (int j = 1; j < m; j++)
+      {
+         Node* current = new Node(px[i][j], py[i][j], _GC);
+         AddLink(last, current, pud[i][j-1]);
+         last = current;
+      }
+      AddLink(last, first, pud[i][m-1]);
+   }
+
+  	TDLI<Graph> _LI=TDLI<Graph>(list);
+   _LI.tohead();
+   while (!_LI.hitroot())
+   {
+      delete _LI.item();
+      _LI.remove();
+   }
+   return true;
+}
+
+//the outline of this simple graph, a closed chain of links, moved by factor to the left of its links.
+//Convex corners are rounded to within aber, unless a sharp corner is within roundfactor*factor of the node.
+//At concave corners the moved links are joined through the node, the small loops that makes go the other way
+//round, and are removed when the outlines are merged on positive winding.
+//The points go in px and py, pud gets the user data of the link each point starts.
+bool Graph::OffsetContour( double factor, double aber, double roundfactor, std::vector<B_INT>& px, std::vector<B_INT>& py, std::vector<int>& pud )
+{
+   int n = _linklist->count();
+   if (n < 3)
+      return true;
+
+   //the nodes, unit directions and user data of the links in order
+   std::vector<Node*> nodes;
+   std::vector<int> user_data;
+   std::vector<double> ux;
+   std::vector<double> uy;
+   nodes.reserve(n);
+   user_data.reserve(n);
+   ux.reserve(n);
+   uy.reserve(n);
+
+   KBoolLink* first = GetFirstLink();
+   KBoolLink* link = first;
+   int count = 0;
+   do
+   {
+      Node* bp = link->GetBeginNode();
+      Node* ep = link->GetEndNode();
+      double dx = (double) (ep->GetX() - bp->GetX());
+      double dy = (double) (ep->GetY() - bp->GetY());
+      double length = sqrt(dx*dx + dy*dy);
+      if (length > 0)
+      {
+         nodes.push_back(bp);
+         user_data.push_back(link->m_user_data);
+         ux.push_back(dx / length);
+         uy.push_back(dy / length);
+      }
+      link = ep->GetOutgoingLink();
+      if (!link)
+         return false; // not a closed chain
+   }
+   while (link != first && ++count < n);
+
+   if (link != first)
+      return false;
+
+   n = (int) nodes.size();
+   if (n < 3)
+      return true;
+
+   //an outline moved to its inside by more than half its width or height is gone,
+   //leave it out instead of merging the tangle of links its moved outline would be
+   double area = 0;
+   B_INT xmin = nodes[0]->GetX(), xmax = xmin, ymin = nodes[0]->GetY(), ymax = ymin;
+   for (int i = 0; i < n; i++)
+   {
+      Node* bp = nodes[i];
+      Node* ep = nodes[(i + 1) % n];
+      area += (double) bp->GetX() * (double) ep->GetY() - (double) ep->GetX() * (double) bp->GetY();
+      if (bp->GetX() < xmin) xmin = bp->GetX();
+      if (bp->GetX() > xmax) xmax = bp->GetX();
+      if (bp->GetY() < ymin) ymin = bp->GetY();
+      if (bp->GetY() > ymax) ymax = bp->GetY();
+   }
+   double size = (double) ((xmax - xmin < ymax - ymin) ? xmax - xmin : ymax - ymin);
+   if ( area * factor > 0 && 2 * fabs(factor) >= size )
+      return true;
+
+   double radius = fabs(factor);
+   double dphi_max = (aber < radius) ? 2*acos((radius-aber)/radius) : M_PI;
+
+   px.reserve(3*n);
+   py.reserve(3*n);
+   pud.reserve(3*n);
+
+   for (int i = 0; i < n; i++)
+   {
+      int next = (i + 1) % n;
+      Node* bp = nodes[i];
+      Node* ep = nodes[next];
+
+      //the link moved to its left, as KBoolLine::Virtual_Point does it
+      AddOffsetPoint( px, py, pud, (B_INT) (bp->GetX() - factor * uy[i]), (B_INT) (bp->GetY() + factor * ux[i]), user_data[i] );
+      AddOffsetPoint( px, py, pud, (B_INT) (ep->GetX() - factor * uy[i]), (B_INT) (ep->GetY() + factor * ux[i]), user_data[i] );
+
+      double cross = ux[i] * uy[next] - uy[i] * ux[next];
+      double dot = ux[i] * ux[next] + uy[i] * uy[next];
+      if ( cross * factor >= 0 )
+      {
+         //concave corner, or none at all
+         if ( cross != 0 || dot < 0 )
+            AddOffsetPoint( px, py, pud, ep->GetX(), ep->GetY(), user_data[i] );
+         continue;
+      }
+
+      //convex corner, the moved links leave a gap
+      double turn = atan2( cross > 0 ? cross : -cross, dot );
+      if ( dot > -1 && cos(turn/2) * roundfactor > 1 )
+      {
+         //sharp enough to keep the corner
+         double mx = -(uy[i] + uy[next]) / (1 + dot);
+         double my = (ux[i] + ux[next]) / (1 + dot);
+         AddOffsetPoint( px, py, pud, (B_INT) (ep->GetX() + factor * mx), (B_INT) (ep->GetY() + factor * my), user_data[i] );
+         continue;
+      }
+
+      //round it with an arc around the node, going clockwise for a positive factor
+      int Segments = (int) ceil( turn / dphi_max );
+      if (Segments > 100)
+         Segments = 100;
+      double phi = atan2( factor * ux[i], -factor * uy[i] );
+      double dphi = (factor > 0) ? -turn / Segments : turn / Segments;
+      for (int j = 1; j < Segments; j++)
+      {
+         phi += dphi;
+         AddOffsetPoint( px, py, pud, (B_INT) (ep->GetX() + radius * cos(phi)), (B_INT) (ep->GetY() + radius * sin(phi)), user_data[i] );
+      }
+   }
+
+   //the last point can be the same as the first
+   while ( px.size() > 1 && px.back() == px[0] && py.back() == py[0] )
+   {
+      px.pop_back();
+      py.pop_back();
+      pud.pop_back();
+   }
+   return true;
+}
+
+//add a point to an offset contour, unless it is the same as the last one
+void Graph::AddOffsetPoint( std::vector<B_INT>& px, std::vector<B_INT>& py, std::vector<int>& pud, B_INT x, B_INT y, int user_data )
+{
+   if ( !px.empty() && px.back() == x && py.back() == y )
+      return;
+   px.push_back(x);
+   py.push_back(y);
+   pud.push_back(user_data);
+}
+
 // Perform an operation on the graph
 void Graph::MakeRing( GraphList* Result, double factor )
 {
@@ -1983,7 +2410,7 @@ void Graph::CreateRing_fast( GraphList *ring, double factor )
    {
    	TDLI<KBoolLink> _LI=TDLI<KBoolLink>(_linklist);
 		_LI.foreach_mf(&KBoolLink::UnMark);//reset bin and mark flag of each link
-		_LI.mergesort(linkYXsorter);
+		_LI.keysort(linkYXkeys);
 	   _LI.tohead();
 
 		begin = GetMostTopLeft(&_LI); // from all the most Top nodes,
@@ -2293,7 +2720,7 @@ bool Graph::MakeClockWise()
 	Node *begin;
 
 	_LI.foreach_mf(&KBoolLink::UnMark);//reset bin and mark flag of each link
-	_LI.mergesort(linkYXtopsorter);
+	_LI.keysort(linkYXtopkeys);
    _LI.tohead();
 
 	begin = GetMostTopLeft(&_LI); // from all the most Top nodes,
@@ -21,54 +21,10 @@
 
 #define LNK _line.GetLink()
 
-//int r_index=-1;
-//void* _Record_Pool[30];
-
-//void DeleteRecordPool()
-//{
-//   while (r_index!=-1)
-//   {
-//     free( _Record_Pool[r_index--]);
-//   }
-//}
-
 Record::~Record()
 {
 }
 
-
-//void* Record::operator new(size_t size)
-//{
-//
-//   if (r_index!=-1)
-//   {
-//     return _Record_Pool[r_index--];
-//   }
-//
-//   return malloc(size);
-//}
-
-//void Record::operator delete(void* recordptr)
-//{
-//
-//   if (r_index < 28)
-//   {
-//     _Record_Pool[++r_index]= recordptr;
-//     return;
-//   }
-//
-//	free (recordptr);
-//}
-
-//void Record::deletepool()
-//{
-//
-//   while (r_index!=-1)
-//   {
-//     free( _Record_Pool[r_index--]);
-//   }
-//}
-
 Record::Record(KBoolLink* link,Bool_Engine* GC)
    :_line(GC)
 {
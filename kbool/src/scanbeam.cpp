@@ -41,10 +41,13 @@ ScanBeam::ScanBeam(Bool_Engine* GC):DL_List<Record*>()
 ScanBeam::~ScanBeam()
 {
    //first delete all record still in the beam
+   //one at a time, as they are pooled, remove_all( true ) would only free the pointers
    _BI.Detach();
-   remove_all( true );
-
-   //DeleteRecordPool(); 
+   while ( !empty() )
+   {
+      delete headitem();
+      removehead();
+   }
 }
 
 void ScanBeam::SetType(Node* low,Node* high)
@@ -54,6 +54,7 @@ namespace geoff_geometry {
 	class Span;
 	class Kurve;
 	class Line;
+	class SpanBoxSweep;
 
 
 	enum UNITS_TYPE{
@@ -708,8 +709,6 @@ inline bool FNEZ(double a, double tolerance = TIGHT_TOLERANCE) {return fabs(a) >
 
 
 
-#define SPANSTORAGE 32			// lessens number of object pointers
-
 	class spVertex {
 		friend wostream& operator <<(wostream& op, spVertex& sp);
 
@@ -746,25 +745,28 @@ inline bool FNEZ(double a, double tolerance = TIGHT_TOLERANCE) {return fabs(a) >
 	};
 
 	class SpanVertex{
+		// one vertex of a Kurve, the Kurve keeps these in one contiguous vector
 	public:
-		int type[SPANSTORAGE];							// LINEAR CW or ACW																// 0 straight (cw = -1 (T)   acw = 1 (A) )
-		int spanid[SPANSTORAGE];						// identification (eg wire offset span info)
-		const SpanDataObject* index[SPANSTORAGE];					// other - pointer to 
-		double x[SPANSTORAGE], y[SPANSTORAGE];			// vertex
-		double xc[SPANSTORAGE], yc[SPANSTORAGE];		// centre of arc
+		int type;							// LINEAR CW or ACW																// 0 straight (cw = -1 (T)   acw = 1 (A) )
+		int spanid;						// identification (eg wire offset span info)
+		const SpanDataObject* index;					// other - pointer to 
+		double x, y;			// vertex
+		double xc, yc;		// centre of arc
 	public:
 		// methods
-		void	Add(int offset, int type, const Point& p0, const Point& pc, int ID = UNMARKED);
-		const SpanDataObject* GetIndex(int offset)const;
-		void	AddSpanID(int offset, int ID);
+		void	Add(int type, const Point& p0, const Point& pc, int ID = UNMARKED);
+		const SpanDataObject* GetIndex()const;
+		void	AddSpanID(int ID);
 		SpanVertex();
+		SpanVertex(const SpanVertex& spv);
+		SpanVertex(SpanVertex&& spv) noexcept;		// takes the index, so growing the vector doesn't copy it
 		~SpanVertex();
 		const SpanVertex& operator= (const SpanVertex& spv );
 
-		void	Add(int offset, const SpanDataObject* Index );
-		const SpanDataObject*	Get(int offset);
-		int		Get(int offset, Point& pe, Point& pc);
-		int GetSpanID(int offset);
+		void	Add(const SpanDataObject* Index );
+		const SpanDataObject*	Get();
+		int		Get(Point& pe, Point& pc)const;
+		int GetSpanID()const;
 	};
 
 
@@ -780,7 +782,7 @@ inline bool FNEZ(double a, double tolerance = TIGHT_TOLERANCE) {return fabs(a) >
 	friend wifstream& operator >> (wifstream& op, Kurve& k);
 		
 	protected:
-		vector<SpanVertex*> m_spans;
+		vector<SpanVertex> m_spans;
 		bool		m_started;
 		int			m_nVertices;					// number of vertices in Kurve
 		bool		m_isReversed;					// true if get spans reversed
@@ -827,6 +829,7 @@ inline bool FNEZ(double a, double tolerance = TIGHT_TOLERANCE) {return fabs(a) >
 		void	Add(const Kurve* k, bool AddNullSpans = true);									// a kurve
 		void	StoreAllSpans(std::vector<Span>& kSpans)const;			// store all kurve spans in array, normally when fast access is reqd
 		void	Clear(); // remove all the spans
+		void	Reserve(int nVertices);		// make room for nVertices, before adding many vertices
 
 		void	Replace(int vertexnumber, const spVertex& spv);
 		void	Replace(int vertexnumber, int type, const Point& p, const Point& pc, int ID = UNMARKED);
@@ -860,6 +863,7 @@ inline bool FNEZ(double a, double tolerance = TIGHT_TOLERANCE) {return fabs(a) >
 
 		int		Offset(vector <Kurve*> &OffsetKurves, double offset, int direction, int method, int& ret)const;	// offset methods
 		int		OffsetMethod1(Kurve& kOffset, double off, int direction,  int method, int& ret)const;
+		void	OffsetMethod1(const vector<double>& leftwards_offs, vector<Kurve>& kOffsets, int method, vector<int>& rets)const;	// an offset for each value (left +ve), done in parallel
 		int		OffsetISOMethod(Kurve& kOffset, double off, int direction, bool BlendAll)const; // special offset (ISO radius - no span elimination)
 		int		Intof(const Span& sp, vector<Point>& p)const;			// intof span
 		int		Intof(const Kurve&k, vector<Point>& p)const;			// intof kurve
@@ -868,6 +872,7 @@ inline bool FNEZ(double a, double tolerance = TIGHT_TOLERANCE) {return fabs(a) >
 		void	ChangeEnd(const Point *pNewEnd, int endSpanno); // change the Kurve's endpoint
 
 	private:
+		int		OffsetMethod1(Kurve& kOffset, double off, int direction,  int method, int& ret, SpanBoxSweep& spans)const;
 		bool compareKurves(const std::vector<struct spanCompare> &first, const std::vector<struct spanCompare> &second, int &nOffset/*, Kurve *k, Matrix *m*/)const;
 		bool calculateMatrix(const Kurve *k, Matrix *m, int nOffset, bool bMirror = false)const;
 	public:
@@ -18,87 +18,103 @@ using namespace geoff_geometry;
 namespace geoff_geometry {
 
 	SpanVertex::SpanVertex() {
-		for(int i = 0; i < SPANSTORAGE; i++) index[i] = NULL;
+		index = NULL;
+	}
+
+	SpanVertex::SpanVertex(const SpanVertex& spv) {
+		index = NULL;
+		*this = spv;
+	}
+
+	SpanVertex::SpanVertex(SpanVertex&& spv) noexcept {
+		type = spv.type;
+		spanid = spv.spanid;
+		index = spv.index;
+		spv.index = NULL;
+		x = spv.x;
+		y = spv.y;
+		xc = spv.xc;
+		yc = spv.yc;
 	}
 
 	SpanVertex::~SpanVertex() {
 #ifndef PEPSDLL 
 		// don't know what peps did about this?
-		for(int i = 0; i < SPANSTORAGE; i++) {
-			if(index[i] != NULL) {
-				delete index[i];
-			}
+		if(index != NULL) {
+			delete index;
 		}
 #endif
 	}
 
 	const SpanVertex& SpanVertex::operator= (const SpanVertex& spv ){
 		/// 
+		if(this == &spv) return *this;
 
-		memcpy(x, spv.x, SPANSTORAGE * sizeof(double));
-		memcpy(y, spv.y, SPANSTORAGE * sizeof(double));
-		memcpy(xc, spv.xc, SPANSTORAGE * sizeof(double));
-		memcpy(yc, spv.yc, SPANSTORAGE * sizeof(double));
+		x = spv.x;
+		y = spv.y;
+		xc = spv.xc;
+		yc = spv.yc;
 
-		for(unsigned int i = 0; i < SPANSTORAGE; i++) {
-			type[i] = spv.type[i];
-			spanid[i] = spv.spanid[i];
-			index[i] = spv.index[i];
+		type = spv.type;
+		spanid = spv.spanid;
 #ifndef PEPSDLL
-			if(index[i] != NULL) {
-				SpanDataObject* obj = new SpanDataObject(index[i]);
-				index[i] = obj;
-			}
-#endif
+		if(index != NULL) delete index;
+		index = NULL;
+		if(spv.index != NULL) {
+			SpanDataObject* obj = new SpanDataObject(spv.index);
+			index = obj;
 		}
+#else
+		index = spv.index;
+#endif
 		return *this;
 	}
 
 
-	void SpanVertex::Add(int offset, int spantype, const Point& p, const Point& pc, int ID)
+	void SpanVertex::Add(int spantype, const Point& p, const Point& pc, int ID)
 	{
-		type[offset] = spantype;
-//		index[offset] = NULL;
-		x[offset] = p.x;
-		y[offset] = p.y;
-		xc[offset] = pc.x;
-		yc[offset] = pc.y;
-		spanid[offset] = ID;
-	}
-	void SpanVertex::AddSpanID(int offset, int ID)
+		type = spantype;
+//		index = NULL;
+		x = p.x;
+		y = p.y;
+		xc = pc.x;
+		yc = pc.y;
+		spanid = ID;
+	}
+	void SpanVertex::AddSpanID(int ID)
 	{
-		spanid[offset] = ID;
+		spanid = ID;
 	}
 
 #if PEPSDLL
-	void SpanVertex::Add(int offset, WireExtraData* Index )
+	void SpanVertex::Add(WireExtraData* Index )
 	{
-		index[offset] = Index;
+		index = Index;
 	}
-	WireExtraData* SpanVertex::Get(int offset)
+	WireExtraData* SpanVertex::Get()
 	{
-		return index[offset];
+		return index;
 	}
 #else
-	void SpanVertex::Add(int offset, const SpanDataObject* Index ) {
-		index[offset] = Index;
+	void SpanVertex::Add(const SpanDataObject* Index ) {
+		index = Index;
 	}
 		
-	const SpanDataObject* SpanVertex::GetIndex(int offset) const{
-		return index[offset];
+	const SpanDataObject* SpanVertex::GetIndex() const{
+		return index;
 	}
 #endif
 
-	int SpanVertex::Get(int offset, Point& pe, Point& pc)
+	int SpanVertex::Get(Point& pe, Point& pc)const
 	{
-		pe = Point(x[offset], y[offset]);
-		pc = Point(xc[offset], yc[offset]);
+		pe = Point(x, y);
+		pc = Point(xc, yc);
 
-		return type[offset];
+		return type;
 	}
-	int SpanVertex::GetSpanID(int offset)
+	int SpanVertex::GetSpanID()const
 	{
-		return spanid[offset];
+		return spanid;
 	}
 
 	Span Span::Offset(double offset)
@@ -422,11 +438,7 @@ namespace geoff_geometry {
 		this->m_mirrored = k.m_mirrored;
 		this->m_isReversed = k.m_isReversed;
 		this->m_started = k.m_started;
-		for(unsigned int i = 0; i < k.m_spans.size(); i++) {
-			SpanVertex* spv = new SpanVertex;
-			*spv = *k.m_spans[i];
-			this->m_spans.push_back(spv);
-		}
+		this->m_spans = k.m_spans;
 	}
 
 	const Kurve& Kurve::operator=( const Kurve &k) {
@@ -445,11 +457,7 @@ namespace geoff_geometry {
 //			k.Get(i, spv);
 //			Add(spv);
 //		}
-		for(unsigned int i = 0; i < k.m_spans.size(); i++) {
-			SpanVertex* spv = new SpanVertex;
-			*spv = *k.m_spans[i];
-			this->m_spans.push_back(spv);
-		}
+		m_spans = k.m_spans;
 		m_nVertices = k.m_nVertices;
 		return *this;
 	}
@@ -589,15 +597,8 @@ return;
 			}
 		}
 
-		SpanVertex* p;
-		if(m_nVertices % SPANSTORAGE == 0) {
-			p = new SpanVertex;
-			m_spans.push_back(p);
-		}
-		else 
-			p = (SpanVertex*) m_spans[m_nVertices / SPANSTORAGE];
-
-		p->Add(m_nVertices % SPANSTORAGE, span_type, p0, pc);
+		m_spans.push_back(SpanVertex());
+		m_spans.back().Add(span_type, p0, pc);
 		m_nVertices++;
 		return true;
 	}
@@ -605,8 +606,7 @@ return;
 	{
 		// add a extra data - must be called after Add
 		int vertex = this->m_nVertices - 1;
-		SpanVertex* p = (SpanVertex*) m_spans[vertex / SPANSTORAGE];
-		p->AddSpanID(vertex % SPANSTORAGE, ID);
+		m_spans[vertex].AddSpanID(ID);
 	}
 
 	void Kurve::Add() {
@@ -678,8 +678,7 @@ return;
 #ifdef _DEBUG
 		if(this == NULL || vertexnumber > m_nVertices) FAILURE(getMessage(L"Kurve::Replace - vertexNumber out of range", GEOMETRY_ERROR_MESSAGES, MES_BAD_VERTEX_NUMBER));
 #endif
-		SpanVertex* p = (SpanVertex*) m_spans[vertexnumber / SPANSTORAGE];
-		p->Add(vertexnumber % SPANSTORAGE, type, p0, pc, ID);
+		m_spans[vertexnumber].Add(type, p0, pc, ID);
 	}
 
 #ifdef PEPSDLL
@@ -688,20 +687,17 @@ return;
 #ifdef _DEBUG
 		if(this == NULL || vertexnumber > m_nVertices) FAILURE(getMessage(L"Kurve::ModifyIndex - vertexNumber out of range", GEOMETRY_ERROR_MESSAGES, MES_BAD_VERTEX_NUMBER));
 #endif
-		SpanVertex* p = (SpanVertex*) m_spans[vertexnumber / SPANSTORAGE];
-		p->Add(vertexnumber % SPANSTORAGE, i);
+		m_spans[vertexnumber].Add(i);
 	}
 #else
 	void Kurve::AddIndex(int vertexNumber, const SpanDataObject* data) {
 		if(this == NULL || vertexNumber > m_nVertices - 1) FAILURE(L"Kurve::AddIndex - vertexNumber out of range");
-		SpanVertex* p = (SpanVertex*) m_spans[vertexNumber / SPANSTORAGE];
-		p->Add(vertexNumber % SPANSTORAGE, data);
+		m_spans[vertexNumber].Add(data);
 	}
 
 	const SpanDataObject* Kurve::GetIndex(int vertexNumber)const {
 		if(this == NULL || vertexNumber > m_nVertices - 1) FAILURE(L"Kurve::GetIndex - vertexNumber out of range");
-		SpanVertex* p = (SpanVertex*) m_spans[vertexNumber / SPANSTORAGE];
-		return p->GetIndex(vertexNumber % SPANSTORAGE);
+		return m_spans[vertexNumber].GetIndex();
 	}
 
 
@@ -726,29 +722,24 @@ return;
 		if(vertexnumber < 0 || vertexnumber >= m_nVertices) FAILURE(getMessage(L"Kurve::Get - vertexNumber out of range", GEOMETRY_ERROR_MESSAGES, MES_BAD_VERTEX_NUMBER));
 		if(m_isReversed == true) {
 			int revVertexnumber = m_nVertices - 1 - vertexnumber;
-			SpanVertex* p = (SpanVertex*)m_spans[revVertexnumber / SPANSTORAGE];
-			int offset = revVertexnumber % SPANSTORAGE;
-			pe = Point(p->x[offset], p->y[offset]);
+			const SpanVertex* p = &m_spans[revVertexnumber];
+			pe = Point(p->x, p->y);
 			if(vertexnumber > 0) {
-				revVertexnumber++;
-				offset = revVertexnumber % SPANSTORAGE;
-				p = (SpanVertex*)m_spans[revVertexnumber / SPANSTORAGE];
-				pc = Point(p->xc[offset], p->yc[offset]);
-				return -p->type[offset];
+				p = &m_spans[revVertexnumber + 1];
+				pc = Point(p->xc, p->yc);
+				return -p->type;
 			}
 			else return LINEAR;
 		}
 		else {
-			SpanVertex* p = (SpanVertex*)m_spans[vertexnumber / SPANSTORAGE];
-			return p->Get(vertexnumber % SPANSTORAGE, pe, pc);
+			return m_spans[vertexnumber].Get(pe, pc);
 		}
 	}
 	int	Kurve::GetSpanID(int vertexnumber) const {
 		// for spanID (wire offset)
 		if(vertexnumber < 0 || vertexnumber >= m_nVertices) FAILURE(getMessage(L"Kurve::Get - vertexNumber out of range", GEOMETRY_ERROR_MESSAGES, MES_BAD_VERTEX_NUMBER));
 		if(m_isReversed == true) vertexnumber = m_nVertices - 1 - vertexnumber;
-		SpanVertex* p = (SpanVertex*)m_spans[vertexnumber / SPANSTORAGE];
-		return p->GetSpanID(vertexnumber % SPANSTORAGE);
+		return m_spans[vertexnumber].GetSpanID();
 	}
 	int Kurve::Get(int spannumber, Span& sp, bool returnSpanProperties, bool transform) const {
 		// returns span data and optional properties - the function returns as the span type
@@ -757,9 +748,9 @@ return;
 
 		int spanVertexNumber = spannumber - 1;
 		if(m_isReversed) spanVertexNumber = m_nVertices - 1 - spanVertexNumber;
-		SpanVertex* p = (SpanVertex*)m_spans[spanVertexNumber / SPANSTORAGE];
-		sp.p0.x = p->x[spanVertexNumber % SPANSTORAGE];
-		sp.p0.y = p->y[spanVertexNumber % SPANSTORAGE];
+		const SpanVertex& v = m_spans[spanVertexNumber];
+		sp.p0.x = v.x;
+		sp.p0.y = v.y;
 		sp.p0.ok = 1;
 
 		sp.dir = Get(spannumber, sp.p1, sp.pc);
@@ -782,9 +773,9 @@ return;
 		if(m_nVertices < 2) return -99;
 
 		int spanVertexNumber = spannumber - 1;
-		SpanVertex* p = (SpanVertex*)m_spans[spanVertexNumber / SPANSTORAGE];
-		sp.p0.x = p->x[spanVertexNumber % SPANSTORAGE];
-		sp.p0.y = p->y[spanVertexNumber % SPANSTORAGE];
+		const SpanVertex& v = m_spans[spanVertexNumber];
+		sp.p0.x = v.x;
+		sp.p0.y = v.y;
 		sp.p0.z = 0;
 //		sp.p0.ok = 1;
 
@@ -1061,8 +1052,8 @@ return;
 	}
 
 	void Kurve::StoreAllSpans(std::vector<Span>& kSpans)const {	// store all kurve spans in array, normally when fast access is reqd
-		Span span;
 		for(int i = 1; i <= this->nSpans(); i++) {
+			Span span;											// a new span each time, SetProperties adds to the box
 			this->Get(i, span, true, false);					
 			kSpans.push_back(span);
 		}
@@ -1070,17 +1061,17 @@ return;
 
 	void Kurve::Clear()
 	{
-		for(vector<SpanVertex*>::iterator It = m_spans.begin(); It != m_spans.end(); It++)
-		{
-			SpanVertex* spv = *It;
-			delete spv;
-		}
 		m_spans.clear();
 		m_started = false;
 		m_nVertices = 0;
 		m_isReversed = false;
 	}
 
+	void Kurve::Reserve(int nVertices)
+	{
+		m_spans.reserve(nVertices);
+	}
+
 	bool Kurve::operator==(const Kurve &k)const{
 		// k = kk (vertex check)
 		if(nSpans() != k.nSpans()) return false;
@@ -10,8 +10,27 @@
 using namespace geoff_geometry;
 
 namespace geoff_geometry {
-	static Kurve eliminateLoops(const Kurve& k , const Kurve& originalk, double offset, int& ret);
-	static bool DoesIntersInterfere(const Point& pInt, const Kurve& k, double offset);
+	class SpanBoxSweep {
+		// the spans of a kurve, for finding the spans whose boxes come near a box without looking at every span
+		// the boxes are sorted on their left side, so only a slice of them needs checking
+		// nothing is worked out until it is first needed, call Sort before sharing one between threads
+		const Kurve& m_k;
+		std::vector<Span> m_spans;			// m_spans[i] is from vertex i to vertex i + 1
+		bool m_spans_stored;
+		std::vector<int> m_order;			// span numbers in order of box min.x
+		std::vector<double> m_left;			// box min.x in that order
+		double m_widest;					// widest box, how far left of the slice a box may start
+		bool m_sorted;
+	public:
+		SpanBoxSweep(const Kurve& k):m_k(k), m_spans_stored(false), m_widest(0.0), m_sorted(false){}
+		const std::vector<Span>& Spans();
+		void Sort();
+		void Find(const Box& box, double margin, std::vector<int>& found);	// spans with boxes within margin of box, in no order
+	};
+
+	static Kurve eliminateLoops(const Kurve& k , SpanBoxSweep& originalk, double offset, int& ret);
+	static bool DoesIntersInterfere(const Point& pInt, SpanBoxSweep& originalk, double offset);
+	static bool BoxesApart(const Box& b0, const Box& b1, double margin);
 
 	int Kurve::Offset(vector<Kurve*>&OffsetKurves, double offset, int direction, int method, int& ret)const {
 
@@ -32,6 +51,35 @@ namespace geoff_geometry {
 	}
 
 	int Kurve::OffsetMethod1(Kurve& kOffset, double off, int direction,  int method, int& ret)const
+	{
+		SpanBoxSweep spans(*this);
+		return OffsetMethod1(kOffset, off, direction, method, ret, spans);
+	}
+
+	void Kurve::OffsetMethod1(const vector<double>& leftwards_offs, vector<Kurve>& kOffsets, int method, vector<int>& rets)const
+	{
+		// offsets this kurve by each of leftwards_offs, kOffsets[i] and rets[i] are as for the single offset
+		// the spans and their boxes are worked out once and shared by all the offsets
+		SpanBoxSweep spans(*this);
+		spans.Sort();
+
+		int n = (int)leftwards_offs.size();
+		kOffsets.clear();
+		kOffsets.resize(n);
+		rets.assign(n, 2);
+
+#pragma omp parallel for schedule(dynamic)
+		for(int i = 0; i < n; i++) {
+			try {
+				OffsetMethod1(kOffsets[i], fabs(leftwards_offs[i]), (leftwards_offs[i] > 0) ? GEOFF_LEFT : GEOFF_RIGHT, method, rets[i], spans);
+			}
+			catch(...) {
+				rets[i] = 2;		// an exception mustn't leave the parallel loop
+			}
+		}
+	}
+
+	int Kurve::OffsetMethod1(Kurve& kOffset, double off, int direction,  int method, int& ret, SpanBoxSweep& spans)const
 	{
 		// offset kurve with simple span elimination
 		// direction 1 = left,  -1 = right
@@ -68,8 +116,9 @@ namespace geoff_geometry {
 
 		bool bClosed = Closed();
 		int nspans = nSpans();
+		const std::vector<Span>& kSpans = spans.Spans();
 		if(bClosed) {
-			Get(nspans, curSpan, true);						// assign previus span for closed
+			curSpan = kSpans[nspans - 1];					// assign previus span for closed
 
 			prevSpanOff = curSpan.Offset(offset);
 			nspans++; // read first again
@@ -77,9 +126,9 @@ namespace geoff_geometry {
 
 		for(int spannumber = 1; spannumber <= nspans; spannumber++) {
 			if(spannumber > nSpans())
-				Get(1, curSpan, true);						// closed kurve - read first span again
+				curSpan = kSpans[0];						// closed kurve - read first span again
 			else
-				Get(spannumber, curSpan, true);
+				curSpan = kSpans[spannumber - 1];
 
 			if(!curSpan.NullSpan) {
 				int numint = 0;
@@ -140,7 +189,7 @@ namespace geoff_geometry {
 			ret = 0;
 			return 1;
 		}
-		kOffset = eliminateLoops(kOffset, *this, offset, ret);
+		kOffset = eliminateLoops(kOffset, spans, offset, ret);
 
 		if(ret == 0 && bClosed) {
 			// check for inverted offsets of closed kurves
@@ -165,7 +214,57 @@ namespace geoff_geometry {
 	}
 
 
-	static Kurve eliminateLoops(const Kurve& k , const Kurve& originalk, double offset, int& ret) {
+	const std::vector<Span>& SpanBoxSweep::Spans() {
+		if(!m_spans_stored) {
+			m_spans.reserve(m_k.nSpans());
+			m_k.StoreAllSpans(m_spans);
+			m_spans_stored = true;
+		}
+		return m_spans;
+	}
+
+	void SpanBoxSweep::Sort() {
+		if(m_sorted) return;
+		const std::vector<Span>& spans = Spans();
+		std::vector< std::pair<double, int> > left;
+		left.reserve(spans.size());
+		for(unsigned int i = 0; i < spans.size(); i++) {
+			const Box& b = spans[i].box;
+			left.push_back(std::make_pair(b.min.x, (int)i));
+			if(b.max.x - b.min.x > m_widest) m_widest = b.max.x - b.min.x;
+		}
+		std::sort(left.begin(), left.end());
+
+		m_order.reserve(left.size());
+		m_left.reserve(left.size());
+		for(unsigned int i = 0; i < left.size(); i++) {
+			m_left.push_back(left[i].first);
+			m_order.push_back(left[i].second);
+		}
+		m_sorted = true;
+	}
+
+	void SpanBoxSweep::Find(const Box& box, double margin, std::vector<int>& found) {
+		Sort();
+
+		double xmax = box.max.x + margin;
+		std::vector<double>::const_iterator It = std::lower_bound(m_left.begin(), m_left.end(), box.min.x - margin - m_widest);
+		for(; It != m_left.end() && *It <= xmax; It++) {
+			int span_number = m_order[It - m_left.begin()];
+			if(!BoxesApart(m_spans[span_number].box, box, margin)) found.push_back(span_number);
+		}
+	}
+
+	static bool BoxesApart(const Box& b0, const Box& b1, double margin) {
+		// true if the boxes are further apart than margin
+		if(b0.max.x + margin < b1.min.x) return true;
+		if(b0.max.y + margin < b1.min.y) return true;
+		if(b0.min.x - margin > b1.max.x) return true;
+		if(b0.min.y - margin > b1.max.y) return true;
+		return false;
+	}
+
+	static Kurve eliminateLoops(const Kurve& k , SpanBoxSweep& originalk, double offset, int& ret) {
 		// a simple loop elimination routine based on first offset ideas in Peps
 		// this needs extensive work for future
 		// start point musn't disappear & only one valid offset is determined
@@ -173,13 +272,20 @@ namespace geoff_geometry {
 		// ret = 0 for ok
 		// ret = 2 for impossible geometry
 		
-		Span sp0, sp1;
+		Span sp0;
 		Point pInt, pIntOther;
 
 		Kurve ko;											// eliminated output
 		ko = Matrix(k);
+		ko.Reserve(k.nSpans() + 1);
 		int kinVertex = 0;
 
+		// spans whose boxes are apart can't intersect, Intof finds intersections up to TOLERANCE outside the spans
+		SpanBoxSweep sweep(k);
+		const std::vector<Span>& spans = sweep.Spans();
+		double boxMargin = 10.0 * geoff_geometry::TOLERANCE;
+		std::vector<int> further;
+
 		while(kinVertex <= k.nSpans()) {
 			bool clipped = false ;                                       // not in a clipped section (assumption with this simple method)
 
@@ -196,17 +302,34 @@ namespace geoff_geometry {
 
 				sp0.SetProperties(true);
 
-				int ksaveVertex1 = kinVertex;									// mark position AA		
 				if (kinVertex <= k.nSpans()) {	// get the next but one span			
-					sp1.dir = k.Get(kinVertex, sp1.p0, sp1.pc);
-					sp1.ID = k.GetSpanID(kinVertex++);
-					int ksaveVertex2 = kinVertex;								// mark position BB
-
-					int fwdCount = 0;
-					while(kinVertex <= k.nSpans()) {					
-						sp1.dir = k.Get(kinVertex, sp1.p1, sp1.pc);			// check span
-						sp1.ID = k.GetSpanID(kinVertex++);
-						sp1.SetProperties(true);
+					// the spans after the next are checked in turn, up to the forward count
+					// in a clipped section the check carries on, but only with the spans whose boxes are near sp0
+					const Box& sp0Box = spans[ksaveVertex - 1].box;		// sp0.box also holds the earlier spans
+					int sp1Number = kinVertex;
+					int fwdLimit = sp1Number + 26;
+					bool searched = false;
+					unsigned int furtherPos = 0;
+
+					while(true) {
+						if(sp1Number > fwdLimit) {
+							if(clipped == false) break;
+							if(!searched) {
+								further.clear();
+								sweep.Find(sp0Box, 2 * boxMargin, further);
+								std::sort(further.begin(), further.end());
+								furtherPos = std::upper_bound(further.begin(), further.end(), fwdLimit) - further.begin();
+								searched = true;
+							}
+							if(furtherPos == further.size()) break;
+							sp1Number = further[furtherPos++];
+						}
+						if(sp1Number >= (int)spans.size()) break;
+						const Span& sp1 = spans[sp1Number];
+						if(BoxesApart(sp0Box, sp1.box, 2 * boxMargin)) {
+							sp1Number++;
+							continue;
+						}
 			
 						double t[4];
 						int numint = sp0.Intof(sp1, pInt, pIntOther, t);			// find span intersections
@@ -226,7 +349,7 @@ namespace geoff_geometry {
 								numint = 1;
 
 							}
-							ksaveVertex = ksaveVertex1 ;
+							ksaveVertex = sp1Number ;
 
 							clipped = true ;			// in a clipped section		
 							if(DoesIntersInterfere(pInt, originalk, offset) == false) {
@@ -236,11 +359,7 @@ namespace geoff_geometry {
 							}
 							// no valid intersection found so carry on
 						}
-						sp1.p0 = sp1.p1 ;		// next
-						ksaveVertex1 = ksaveVertex2 ;							// pos AA = BB
-						ksaveVertex2 = kinVertex;								// mark 
-
-						if((kinVertex > k.nSpans() || fwdCount++ > 25) && clipped == false) break;
+						sp1Number++;		// next
 					}
 				}
 
@@ -261,20 +380,22 @@ namespace geoff_geometry {
 	}
 
 
-	static bool DoesIntersInterfere(const Point& pInt, const Kurve& k, double offset)  {
+	static bool DoesIntersInterfere(const Point& pInt, SpanBoxSweep& originalk, double offset)  {
 		// check that intersections don't interfere with the original kurve 
-		Span sp;
+		// only spans with boxes within offset of pInt can be nearer than offset
 		Point dummy;
-		int kCheckVertex = 0;
-		k.Get(kCheckVertex++, sp.p0, sp.pc);
-
 		offset = fabs(offset) - geoff_geometry::TOLERANCE;
-		while(kCheckVertex <= k.nSpans()) {
-			sp.dir = k.Get(kCheckVertex++, sp.p1, sp.pc);
-			sp.SetProperties(true);
+		if(offset <= 0.0) return false;
+
+		Box box;
+		box.min = box.max = pInt;
+		box.ok = true;
+		std::vector<int> near;
+		originalk.Find(box, offset + 10.0 * geoff_geometry::TOLERANCE, near);
+		const std::vector<Span>& spans = originalk.Spans();
+		for(unsigned int i = 0; i < near.size(); i++) {
 			// check for interference 
-			if(Dist(sp, pInt, dummy) < offset) return true;
-			sp.p0 = sp.p1;
+			if(Dist(spans[near[i]], pInt, dummy) < offset) return true;
 		}
 		return false;	// intersection is ok
 	}
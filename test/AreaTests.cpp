@@ -0,0 +1,391 @@
+// AreaTests.cpp
+// This program is released under the BSD license. See the file COPYING for details.
+
+// checks CArea operations against answers worked out another way, on cases that have gone wrong before
+//
+// usage: area_tests [filter]
+// only tests with the filter text in their name are run; it returns 1 if any of them failed
+
+#include "Area.h"
+#include "AreaCache.h"
+#include "AreaIncrementalPocket.h"
+#include "AreaPocketPreview.h"
+
+#include <cstdio>
+#include <cstring>
+#include <math.h>
+
+static const double PI = 3.1415926535897932;
+
+static int failures = 0;
+
+#define CHECK(condition) if(!(condition)){printf("  %s:%d: failed: %s\n", __FILE__, __LINE__, #condition); failures++;}
+
+typedef void (*TestFunction)();
+
+static bool Near(double a, double b, double tolerance)
+{
+	// tolerance is relative to the size of b, with a small absolute part for values near zero
+	return fabs(a - b) <= tolerance * (fabs(b) + 1.0);
+}
+
+static Point PointOnCircle(const Point &c, double r, double degrees)
+{
+	double a = degrees * PI / 180;
+	return Point(c.x + r * cos(a), c.y + r * sin(a));
+}
+
+static CCurve Circle(const Point &c, double r, bool clockwise)
+{
+	// made of two semicircles
+	int dir = clockwise ? -1 : 1;
+	CCurve curve;
+	curve.append(Point(c.x + r, c.y));
+	curve.append(CVertex(dir, Point(c.x - r, c.y), c));
+	curve.append(CVertex(dir, Point(c.x + r, c.y), c));
+	return curve;
+}
+
+static CCurve Pacman(const Point &c, double r, double start_degrees, double end_degrees)
+{
+	// an anticlockwise arc from start to end, closed through the centre
+	// if end is a bit less than start, the arc goes the long way round, starting and ending in the same quadrant
+	CCurve curve;
+	curve.append(PointOnCircle(c, r, start_degrees));
+	curve.append(CVertex(1, PointOnCircle(c, r, end_degrees), c));
+	curve.append(c);
+	curve.append(PointOnCircle(c, r, start_degrees));
+	return curve;
+}
+
+static double LensArea(double r0, double r1, double d)
+{
+	// the area of the overlap of two circles, d apart
+	double a0 = acos((d*d + r0*r0 - r1*r1) / (2*d*r0));
+	double a1 = acos((d*d + r1*r1 - r0*r0) / (2*d*r1));
+	return r0*r0*a0 + r1*r1*a1 - 0.5 * sqrt((-d + r0 + r1) * (d + r0 - r1) * (d - r0 + r1) * (d + r0 + r1));
+}
+
+static void ArcBooleansOnLongArcs()
+{
+	// the arc of a's mouth starts and ends in the first quadrant and goes the long way round, past b
+	CAreaSettings settings;
+	CArea::m_arc_booleans = true;
+	CArea a, b;
+	a.append(Pacman(Point(0, 0), 10, 70, 20));
+	b.append(Circle(Point(0, -10), 1, false));
+	double a_area = 0.5 * 10 * 10 * (310 * PI / 180);
+	double b_area = PI;
+	double overlap = LensArea(10, 1, 10);
+
+	CArea subtract_result = a;
+	subtract_result.Subtract(b);
+	CHECK(subtract_result.m_curves.size() == 1);
+	CHECK(Near(fabs(subtract_result.GetArea()), a_area - overlap, 1.0e-6));
+
+	CArea intersect_result = a;
+	intersect_result.Intersect(b);
+	CHECK(intersect_result.m_curves.size() == 1);
+	CHECK(Near(fabs(intersect_result.GetArea()), overlap, 1.0e-6));
+
+	CArea union_result = a;
+	union_result.Union(b);
+	CHECK(union_result.m_curves.size() == 1);
+	CHECK(Near(fabs(union_result.GetArea()), a_area + b_area - overlap, 1.0e-6));
+
+	settings.Apply();
+}
+
+static void ReorderLongArcs()
+{
+	// the hole is inside the pacman's box, but not inside the box of the ends of its arc
+	CArea a;
+	a.append(Pacman(Point(0, 0), 10, 70, 20));
+	a.append(Circle(Point(-5, -5), 1, false));
+	a.Reorder();
+
+	CHECK(a.m_curves.size() == 2);
+	if(a.m_curves.size() == 2)
+	{
+		CHECK(!a.m_curves.front().IsClockwise());
+		CHECK(a.m_curves.back().IsClockwise());
+	}
+	CHECK(Near(a.GetArea(), -(0.5 * 10 * 10 * (310 * PI / 180) - PI), 1.0e-6));
+}
+
+static bool SameCurve(const CCurve& c0, const CCurve& c1)
+{
+	if(c0.m_vertices.size() != c1.m_vertices.size())return false;
+	std::list<CVertex>::const_iterator VIt1 = c1.m_vertices.begin();
+	for(std::list<CVertex>::const_iterator VIt0 = c0.m_vertices.begin(); VIt0 != c0.m_vertices.end(); VIt0++, VIt1++)
+	{
+		const CVertex& v0 = *VIt0;
+		const CVertex& v1 = *VIt1;
+		if(v0.m_type != v1.m_type || v0.m_p.dist(v1.m_p) > 1.0e-9)return false;
+		if(v0.m_type && v0.m_c.dist(v1.m_c) > 1.0e-9)return false;
+	}
+	return true;
+}
+
+static void SpanIndexOnLongArcs()
+{
+	// CCurveSpanIndex must give the same answers as going along the spans, on arcs whose end points are all in one quadrant
+	std::list<CCurve> curves;
+	curves.push_back(Pacman(Point(0, 0), 10, 70, 20));
+	curves.push_back(Pacman(Point(3, 4), 5, 200, 190));
+	curves.back().Reverse();
+
+	for(std::list<CCurve>::iterator It = curves.begin(); It != curves.end(); It++)
+	{
+		const CCurve& linear = *It;
+		CCurve indexed = linear;
+		indexed.SpanIndex();
+
+		double perim = linear.Perim();
+		for(int i = 1; i<40; i++)
+		{
+			Point p = linear.PerimToPoint(perim * i / 40);
+			CHECK(indexed.PerimToPoint(perim * i / 40).dist(p) < 1.0e-9);
+			CHECK(Near(indexed.PointToPerim(p), linear.PointToPerim(p), 1.0e-9));
+
+			CCurve c0 = linear, c1 = indexed;
+			c0.ChangeStart(p);
+			c1.ChangeStart(p);
+			CHECK(SameCurve(c0, c1));
+
+			c0 = linear; c1 = indexed;
+			c0.ChangeEnd(p);
+			c1.ChangeEnd(p);
+			CHECK(SameCurve(c0, c1));
+
+			c0 = linear; c1 = indexed;
+			c0.Break(p);
+			c1.Break(p);
+			CHECK(SameCurve(c0, c1));
+		}
+	}
+}
+
+static void CacheKeepsSettingsApart()
+{
+	// a result worked out with one setting must not be given back for another
+	CAreaSettings settings;
+	CArea a, b;
+	a.append(Pacman(Point(0, 0), 10, 70, 20));
+	b.append(Circle(Point(0, -10), 1, false));
+
+	CArea::m_arc_booleans = true;
+	CArea arc_result = a;
+	arc_result.Subtract(b);
+	CArea::m_arc_booleans = false;
+	CArea engine_result = a;
+	engine_result.Subtract(b);
+	CHECK(!SameGeometry(arc_result, engine_result));
+
+	CArea::SetCacheSize(10);
+	for(int i = 0; i<2; i++)
+	{
+		CArea::m_arc_booleans = (i == 0);
+		CArea cached_result = a;
+		cached_result.Subtract(b);
+		CHECK(SameGeometry(cached_result, (i == 0) ? arc_result : engine_result));
+	}
+	CArea::SetCacheSize(0);
+
+	settings.Apply();
+}
+
+static CCurve Rectangle(double x0, double y0, double x1, double y1)
+{
+	CCurve curve;
+	curve.append(Point(x0, y0));
+	curve.append(Point(x1, y0));
+	curve.append(Point(x1, y1));
+	curve.append(Point(x0, y1));
+	curve.append(Point(x0, y0));
+	return curve;
+}
+
+static void IncrementalPocketSettings()
+{
+	// changing a setting which changes the toolpath must pocket every region again
+	CAreaSettings settings;
+	CArea a;
+	a.append(Rectangle(0, 0, 10, 10));
+	a.append(Rectangle(20, 0, 30, 10));
+	CAreaIncrementalPocket pocket(CAreaPocketParams(1.0, 0.0, 0.5, false, SpiralPocketMode, 0.0));
+	std::list<CCurve> toolpath;
+
+	pocket.MakePocketToolpath(a, toolpath);
+	CHECK(pocket.NumRegionsMade() == 2);
+	pocket.MakePocketToolpath(a, toolpath);
+	CHECK(pocket.NumRegionsKept() == 2);
+
+	for(int i = 0; i<3; i++)
+	{
+		switch(i)
+		{
+		case 0: CArea::m_simplify_tolerance = 0.01; break;
+		case 1: CArea::m_arc_booleans = !CArea::m_arc_booleans; break;
+		default: CArea::m_strips = CArea::m_strips + 2; break;
+		}
+		pocket.MakePocketToolpath(a, toolpath);
+		CHECK(pocket.NumRegionsMade() == 2 && pocket.NumRegionsKept() == 0);
+		pocket.MakePocketToolpath(a, toolpath);
+		CHECK(pocket.NumRegionsKept() == 2);
+	}
+
+	settings.Apply();
+}
+
+static double ToolpathLength(const std::list<CCurve> &toolpath)
+{
+	double length = 0.0;
+	for(std::list<CCurve>::const_iterator It = toolpath.begin(); It != toolpath.end(); It++)length += It->Perim();
+	return length;
+}
+
+static void PocketPreviewZigZagLength()
+{
+	// the preview's zigs are scaled up to the exact toolpath's number of them, but not its zags along the boundary
+	CArea a;
+	a.append(Rectangle(0, 0, 60, 60));
+	for(int i = 0; i<3; i++)
+	{
+		for(int j = 0; j<3; j++)
+		{
+			a.append(Circle(Point(10 + i * 20, 10 + j * 20), 4, true));
+		}
+	}
+
+	for(int i = 0; i<2; i++)
+	{
+		CAreaPocketParams params(1.0, 0.0, 0.5, false, (i == 0) ? ZigZagPocketMode : ZigZagThenSingleOffsetPocketMode, 30.0);
+		std::list<CCurve> exact_toolpath;
+		a.SplitAndMakePocketToolpath(exact_toolpath, params);
+
+		CAreaPocketPreview preview(params);
+		preview.m_max_stepovers = 30;
+		std::list<CCurve> preview_toolpath;
+		preview.MakePocketToolpath(a, preview_toolpath);
+		CHECK(preview.StepoverUsed() > 3 * params.stepover);
+		CHECK(Near(preview.Length(), ToolpathLength(exact_toolpath), 0.05));
+	}
+}
+
+class Random
+{
+	// a small generator of its own, so the tests don't depend on the platform's rand()
+	unsigned int m_seed;
+public:
+	Random(unsigned int seed):m_seed(seed){}
+	double Next(){m_seed = m_seed * 1103515245 + 12345; return ((m_seed >> 8) & 0xffffff) / 16777216.0;} // 0 to 1
+};
+
+static CCurve Star(const Point &c, double r, int points)
+{
+	// anti-clockwise, the inner points are at half the radius
+	CCurve curve;
+	for(int i = 0; i <= 2 * points; i++)
+	{
+		curve.append(PointOnCircle(c, (i % 2) ? r * 0.5 : r, (i % (2 * points)) * 180.0 / points));
+	}
+	return curve;
+}
+
+static double AreaOutside(const CArea& a, const CArea& b)
+{
+	// the area of a which isn't in b
+	CArea difference = a;
+	difference.Subtract(b);
+	return fabs(difference.GetArea());
+}
+
+static void StripsMatchOneGo()
+{
+	// the strips, joined up again, must give the same curves as doing it in one go
+	// the stars overlap each other and the seams, and leave islands in the holes of the sheet
+	// with this seed the offset stars used to come back as more curves than they should, from holes and pieces not joined across the seams
+	CAreaSettings settings;
+	CArea stars;
+	Random random(10);
+	for(int i = 0; i<8; i++)
+	{
+		for(int j = 0; j<8; j++)
+		{
+			double x = i * 10 + random.Next() * 2 - 1;
+			double y = j * 10 + random.Next() * 2 - 1;
+			stars.append(Star(Point(x, y), 3 + random.Next() * 3, 30));
+		}
+	}
+	CArea sheet;
+	sheet.append(Rectangle(-10, -10, 85, 85));
+	CArea ring;
+	ring.append(Rectangle(-5, -5, 80, 80));
+	ring.append(Rectangle(20, 20, 55, 55));
+	ring.m_curves.back().Reverse();
+
+	for(int i = 0; i<5; i++)
+	{
+		CArea result[2];
+		for(int strips = 0; strips<2; strips++)
+		{
+			CArea::m_strips = strips ? 4 : 0;
+			CArea::m_strip_min_vertices = 50;
+			switch(i)
+			{
+			case 0: result[strips] = sheet; result[strips].Subtract(stars); break;
+			case 1: result[strips] = stars; result[strips].Union(ring); break;
+			case 2: result[strips] = ring; result[strips].Intersect(stars); break;
+			case 3: result[strips] = stars; result[strips].Offset(-2.0); break;
+			default: result[strips] = stars; result[strips].Offset(0.5); break;
+			}
+		}
+
+		CArea::m_strips = 0;
+		double area = fabs(result[0].GetArea());
+		CHECK(result[1].m_curves.size() == result[0].m_curves.size());
+		CHECK(Near(fabs(result[1].GetArea()), area, 1.0e-4));
+		CHECK(AreaOutside(result[0], result[1]) < area * 1.0e-3);
+		CHECK(AreaOutside(result[1], result[0]) < area * 1.0e-3);
+	}
+
+	settings.Apply();
+}
+
+struct Test
+{
+	const char* m_name;
+	TestFunction m_function;
+};
+
+static const Test tests[] = {
+	{"ArcBooleansOnLongArcs", ArcBooleansOnLongArcs},
+	{"ReorderLongArcs", ReorderLongArcs},
+	{"SpanIndexOnLongArcs", SpanIndexOnLongArcs},
+	{"CacheKeepsSettingsApart", CacheKeepsSettingsApart},
+	{"IncrementalPocketSettings", IncrementalPocketSettings},
+	{"PocketPreviewZigZagLength", PocketPreviewZigZagLength},
+	{"StripsMatchOneGo", StripsMatchOneGo},
+};
+
+int main(int argc, char* argv[])
+{
+	const char* filter = (argc > 1) ? argv[1] : NULL;
+	int tests_run = 0;
+	int tests_failed = 0;
+
+	for(unsigned int i = 0; i<sizeof(tests) / sizeof(Test); i++)
+	{
+		const Test &test = tests[i];
+		if(filter && strstr(test.m_name, filter) == NULL)continue;
+		int failures_before = failures;
+		printf("%s\n", test.m_name);
+		test.m_function();
+		tests_run++;
+		if(failures != failures_before)tests_failed++;
+	}
+
+	printf("%d tests run, %d failed\n", tests_run, tests_failed);
+	return (tests_failed > 0) ? 1 : 0;
+}